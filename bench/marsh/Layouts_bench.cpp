@@ -0,0 +1,118 @@
+//: bench/marsh/Layouts_bench.cpp
+
+#include "leaqx8664.hpp"
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+
+using leaqx8664::marsh::Matrix;
+
+/////////////////////
+// LAYOUT BENCHMARKS
+/////////////////////
+    ////////////////////
+    // Time the product of two n x n matrices stored with layout L
+    ////////////////////
+    template <typename L>
+    double bench_multiply(size_t n);
+    ////////////////////
+    // Time a column sweep, summing every column of an n x n matrix
+    // stored with layout L
+    ////////////////////
+    template <typename L>
+    double bench_column_sweep(size_t n);
+    ////////////////////
+    // Print the timings of every layout for one size
+    ////////////////////
+    template <typename L>
+    void report(const std::string& name, size_t n);
+
+
+//usage: Layouts_bench [size...], sizes default to 256 512 1024
+int main(int argc, char** argv){
+
+    std::vector<size_t> sizes{256, 512, 1024};
+    if (argc > 1){
+
+	sizes.clear();
+	for (int i = 1; i < argc; ++i)
+	    sizes.push_back(std::strtoul(argv[i], nullptr, 10));
+    }
+
+    std::cerr << std::setw(16) << std::left << "layout" << std::setw(8) << "n" << std::setw(16) << "multiply (s)" << "column sweep (s)" << std::endl;
+    for (const auto n : sizes){
+
+	report<leaqx8664::marsh::Row_major>("Row_major", n);
+	report<leaqx8664::marsh::Column_major>("Column_major", n);
+	report<leaqx8664::marsh::Tiled<32>>("Tiled<32>", n);
+	report<leaqx8664::marsh::Morton>("Morton", n);
+    }
+}
+
+    template <typename L>
+    Matrix<double, L> bench_matrix(size_t n, double shift){
+
+	Matrix<double, L> mat{n, n};
+	for (size_t i = 0; i < n; ++i)
+	    for (size_t j = 0; j < n; ++j)
+		mat(i,j) = std::cos(shift + 0.01*i + 0.02*j);
+	return mat;
+    }
+    //best of three runs of f
+    template <typename F>
+    double best_time(F f){
+
+	double best = 0;
+	for (int run = 0; run < 3; ++run){
+
+	    const auto start = std::chrono::steady_clock::now();
+	    f();
+	    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	    if (run == 0 || elapsed.count() < best)
+		best = elapsed.count();
+	}
+	return best;
+    }
+
+/////////////////////
+// LAYOUT BENCHMARKS
+/////////////////////
+    template <typename L>
+    double bench_multiply(size_t n){
+
+	const auto a = bench_matrix<L>(n, 0.0), b = bench_matrix<L>(n, 1.0);
+	volatile double sink = 0;
+	const double time = best_time([&](){ sink = sink + (a*b)(n/2, n/3);});
+	return time;
+    }
+    template <typename L>
+    double bench_column_sweep(size_t n){
+
+	const auto a = bench_matrix<L>(n, 0.0);
+	std::vector<double> sums(n);
+	volatile double sink = 0;
+	const double time = best_time([&](){
+	    for (int repeat = 0; repeat < 10; ++repeat){
+
+		for (size_t j = 0; j < n; ++j){
+
+		    double sum = 0;
+		    for (size_t i = 0; i < n; ++i)
+			sum += a(i,j);
+		    sums[j] = sum;
+		}
+		sink = sink + sums[n/2];
+	    }
+	});
+	return time / 10;
+    }
+    template <typename L>
+    void report(const std::string& name, size_t n){
+
+	std::cerr << std::setw(16) << std::left << name << std::setw(8) << n << std::setw(16) << std::fixed << std::setprecision(4) << bench_multiply<L>(n)
+	    << bench_column_sweep<L>(n) << std::endl;
+    }
@@ -0,0 +1,15 @@
+//: leaqx8664/exceptions/CommunicationException.hpp 
+
+#ifndef LIB_LEAQ_COMMUNICATION_EXCEPTION_HPP
+#define LIB_LEAQ_COMMUNICATION_EXCEPTION_HPP
+
+#include <exception>
+
+class CommunicationException : std::exception {
+
+    const char* what() const noexcept{
+    
+	return "Communication with another process failed";
+    }
+};
+#endif
@@ -0,0 +1,15 @@
+//: leaqx8664/exceptions/ShapeMismatchException.hpp 
+
+#ifndef LIB_LEAQ_SHAPE_MISMATCH_EXCEPTION_HPP
+#define LIB_LEAQ_SHAPE_MISMATCH_EXCEPTION_HPP
+
+#include <exception>
+
+class ShapeMismatchException : std::exception {
+
+    const char* what() const noexcept{
+    
+	return "Incompatible matrix shapes";
+    }
+};
+#endif
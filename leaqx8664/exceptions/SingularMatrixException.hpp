@@ -0,0 +1,15 @@
+//: leaqx8664/exceptions/SingularMatrixException.hpp 
+
+#ifndef LIB_LEAQ_SINGULAR_MATRIX_EXCEPTION_HPP
+#define LIB_LEAQ_SINGULAR_MATRIX_EXCEPTION_HPP
+
+#include <exception>
+
+class SingularMatrixException : std::exception {
+
+    const char* what() const noexcept{
+    
+	return "Singular matrix";
+    }
+};
+#endif
@@ -6,5 +6,8 @@
 //include ExpiredIteratorException header
 #include "exceptions/ExpiredIteratorException.hpp"
 #include "exceptions/IndexOutOfBoundsException.hpp"
+#include "exceptions/ShapeMismatchException.hpp"
+#include "exceptions/SingularMatrixException.hpp"
+#include "exceptions/CommunicationException.hpp"
 
 #endif
@@ -6,7 +6,31 @@
 //include library exceptions
 #include "leaq_exceptions.hpp"
 
+//include storage layouts header
+#include <marsh/Layouts.hpp>
+//include Vector class header
+#include <marsh/Vector.hpp>
 //include Matrix class header
 #include <marsh/Matrix.hpp>
+//include thread pool header
+#include <marsh/Thread_pool.hpp>
+//include parallel helpers header
+#include <marsh/Parallel.hpp>
+//include vector and matrix kernels header
+#include <marsh/Blas.hpp>
+//include matrix reductions header
+#include <marsh/Reductions.hpp>
+//include packed and banded matrices header
+#include <marsh/Packed.hpp>
+//include task graph header
+#include <marsh/Task_graph.hpp>
+//include content hash header
+#include <marsh/Hash.hpp>
+//include result cache header
+#include <marsh/Result_cache.hpp>
+//include process transports header
+#include <marsh/Transport.hpp>
+//include distributed matrices header
+#include <marsh/Distributed.hpp>
 
 #endif
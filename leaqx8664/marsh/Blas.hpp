@@ -0,0 +1,466 @@
+//: marsh/Blas.hpp
+/**
+ * @file marsh/Blas.hpp
+ */
+
+#ifndef MARSH_BLAS_HPP
+#define MARSH_BLAS_HPP
+
+/*
+ * Include headers
+ */
+#include <cmath>
+#include <vector>
+#include <type_traits>
+
+#include "../leaq_exceptions.hpp"
+#include "Layouts.hpp"
+#include "Parallel.hpp"
+#include "Vector.hpp"
+#include "Matrix.hpp"
+
+namespace leaqx8664{
+
+    namespace marsh{
+
+	/////////////////////
+	// KERNEL OPTIONS
+	/////////////////////
+	    //! Whether a kernel uses a matrix or its transpose
+	    enum class Transpose { no_transpose, transpose };
+	    //! Which triangle of a matrix a kernel reads
+	    enum class Triangle { upper, lower };
+	    //! Whether the diagonal of a triangular matrix is made of ones
+	    enum class Diagonal { non_unit, unit };
+
+	/////////////////////
+	// LOW LEVEL KERNELS
+	/////////////////////
+	namespace detail{
+
+	    //! Minimum number of elements a thread works on
+	    constexpr size_t blas_grain = size_t{1} << 15;
+
+	    //! Scalar type of a vector or view, without qualifiers
+	    template <typename V>
+	    using vector_scalar = typename std::remove_cv<typename std::remove_reference<V>::type::scalar_type>::type;
+
+	    /**
+	     * Dot product of n elements of x and y. The contiguous case uses independent
+	     * accumulators so the compiler can keep several SIMD lanes busy.
+	     */
+	    template <typename T>
+	    T dot_kernel (const T* x, const size_t x_stride, const T* y, const size_t y_stride, const size_t n) noexcept {
+
+		T s0{}, s1{}, s2{}, s3{};
+		size_t i = 0;
+		if (x_stride == 1 && y_stride == 1){
+
+		    for (; i + 4 <= n; i += 4){
+
+			s0 += x[i]*y[i];
+			s1 += x[i + 1]*y[i + 1];
+			s2 += x[i + 2]*y[i + 2];
+			s3 += x[i + 3]*y[i + 3];
+		    }
+		    for (; i < n; ++i)
+			s0 += x[i]*y[i];
+		}
+		else{
+
+		    for (; i < n; ++i)
+			s0 += x[i*x_stride]*y[i*y_stride];
+		}
+		return (s0 + s1) + (s2 + s3);
+	    }
+	    /**
+	     * y += alpha*x on n elements
+	     */
+	    template <typename T>
+	    void axpy_kernel (const T alpha, const T* x, const size_t x_stride, T* y, const size_t y_stride, const size_t n) noexcept {
+
+		if (x_stride == 1 && y_stride == 1){
+
+		    for (size_t i = 0; i < n; ++i)
+			y[i] += alpha*x[i];
+		}
+		else{
+
+		    for (size_t i = 0; i < n; ++i)
+			y[i*y_stride] += alpha*x[i*x_stride];
+		}
+	    }
+	    /**
+	     * x *= alpha on n elements, alpha equal to zero clears x
+	     */
+	    template <typename T>
+	    void scal_kernel (const T alpha, T* x, const size_t x_stride, const size_t n) noexcept {
+
+		if (alpha == T{}){
+
+		    for (size_t i = 0; i < n; ++i)
+			x[i*x_stride] = T{};
+		}
+		else if (x_stride == 1){
+
+		    for (size_t i = 0; i < n; ++i)
+			x[i] *= alpha;
+		}
+		else{
+
+		    for (size_t i = 0; i < n; ++i)
+			x[i*x_stride] *= alpha;
+		}
+	    }
+	    /**
+	     * Accumulate the n elements of x in the scaled sum of squares scale^2*sum_of_squares
+	     */
+	    template <typename T>
+	    void sum_of_squares_kernel (const T* x, const size_t x_stride, const size_t n, T& scale, T& sum_of_squares) noexcept {
+
+		for (size_t i = 0; i < n; ++i){
+
+		    const T value = std::abs(x[i*x_stride]);
+		    if (value == T{})
+			continue;
+		    if (scale < value){
+
+			sum_of_squares = T{1} + sum_of_squares*(scale/value)*(scale/value);
+			scale = value;
+		    }
+		    else
+			sum_of_squares += (value/scale)*(value/scale);
+		}
+	    }
+	    /**
+	     * Add the scaled sum of squares (scale, sum_of_squares) to (result_scale, result_sum)
+	     */
+	    template <typename T>
+	    void merge_sum_of_squares (const T scale, const T sum_of_squares, T& result_scale, T& result_sum) noexcept {
+
+		if (scale == T{})
+		    return;
+		if (result_scale < scale){
+
+		    result_sum = sum_of_squares + result_sum*(result_scale/scale)*(result_scale/scale);
+		    result_scale = scale;
+		}
+		else
+		    result_sum += sum_of_squares*(scale/result_scale)*(scale/result_scale);
+	    }
+	    /**
+	     * Check that a vector has the expected number of elements
+	     */
+	    template <typename V>
+	    void check_size (const V& x, const size_t n){
+
+		if (x.get_size() != n)
+		    throw ShapeMismatchException{};
+	    }
+	}
+
+	/////////////////////
+	// LEVEL 1 KERNELS
+	/////////////////////
+	    /**
+	     * @brief Dot product of two vectors
+	     *
+	     * Vectors are split in at most get_num_threads() chunks whose partial results are added
+	     * in a fixed order, so the result is reproducible for a fixed number of threads.
+	     *
+	     * @param x First operand, a Vector or a Vector_view
+	     * @param y Second operand, a Vector or a Vector_view
+	     * @returns The sum of x(i)*y(i)
+	     *
+	     * @throws ShapeMismatchException if x and y have different sizes.
+	     */
+	    template <typename V1, typename V2>
+	    detail::vector_scalar<V1> dot (const V1& x, const V2& y){
+
+		using T = detail::vector_scalar<V1>;
+		detail::check_size(y, x.get_size());
+
+		const T* x_data = x.data();
+		const T* y_data = y.data();
+		const size_t x_stride = x.get_stride(), y_stride = y.get_stride();
+		const size_t n_chunks = parallel_chunks(0, x.get_size(), detail::blas_grain);
+		std::vector<T> partial(n_chunks, T{});
+		parallel_for_chunks(0, x.get_size(), n_chunks, [&](size_t chunk, size_t begin, size_t end){
+		    partial[chunk] = detail::dot_kernel(x_data + begin*x_stride, x_stride, y_data + begin*y_stride, y_stride, end - begin);
+		});
+
+		T result{};
+		for (const auto& value : partial)
+		    result += value;
+		return result;
+	    }
+	    /**
+	     * @brief Euclidean norm of a vector
+	     *
+	     * The norm is computed from a scaled sum of squares, so it does not overflow
+	     * or underflow unless the result does.
+	     *
+	     * @param x A Vector or a Vector_view
+	     * @returns The square root of the sum of x(i)^2
+	     */
+	    template <typename V>
+	    detail::vector_scalar<V> nrm2 (const V& x){
+
+		using T = detail::vector_scalar<V>;
+		const T* x_data = x.data();
+		const size_t x_stride = x.get_stride();
+		const size_t n_chunks = parallel_chunks(0, x.get_size(), detail::blas_grain);
+		std::vector<T> scale(n_chunks, T{}), sum_of_squares(n_chunks, T{1});
+		parallel_for_chunks(0, x.get_size(), n_chunks, [&](size_t chunk, size_t begin, size_t end){
+		    detail::sum_of_squares_kernel(x_data + begin*x_stride, x_stride, end - begin, scale[chunk], sum_of_squares[chunk]);
+		});
+
+		T result_scale{}, result_sum{1};
+		for (size_t chunk = 0; chunk < n_chunks; ++chunk)
+		    detail::merge_sum_of_squares(scale[chunk], sum_of_squares[chunk], result_scale, result_sum);
+		return result_scale*std::sqrt(result_sum);
+	    }
+	    /**
+	     * @brief Compute y = alpha*x + y
+	     *
+	     * @param alpha Scalar multiplying x
+	     * @param x A Vector or a Vector_view
+	     * @param y A Vector or a Vector_view, updated in place
+	     *
+	     * @throws ShapeMismatchException if x and y have different sizes.
+	     */
+	    template <typename T, typename V1, typename V2>
+	    void axpy (const T alpha, const V1& x, V2&& y){
+
+		detail::check_size(y, x.get_size());
+
+		const auto* x_data = x.data();
+		auto* y_data = y.data();
+		const size_t x_stride = x.get_stride(), y_stride = y.get_stride();
+		parallel_for(0, x.get_size(), detail::blas_grain, [&](size_t, size_t begin, size_t end){
+		    detail::axpy_kernel<detail::vector_scalar<V2>>(alpha, x_data + begin*x_stride, x_stride, y_data + begin*y_stride, y_stride, end - begin);
+		});
+	    }
+	    /**
+	     * @brief Compute x = alpha*x
+	     *
+	     * @param alpha Scalar multiplying x
+	     * @param x A Vector or a Vector_view, updated in place
+	     */
+	    template <typename T, typename V>
+	    void scal (const T alpha, V&& x){
+
+		auto* x_data = x.data();
+		const size_t x_stride = x.get_stride();
+		parallel_for(0, x.get_size(), detail::blas_grain, [&](size_t, size_t begin, size_t end){
+		    detail::scal_kernel<detail::vector_scalar<V>>(alpha, x_data + begin*x_stride, x_stride, end - begin);
+		});
+	    }
+
+	/////////////////////
+	// LEVEL 2 KERNELS
+	/////////////////////
+	    /**
+	     * @brief Compute y = alpha*op(a)*x + beta*y, where op(a) is a or its transpose
+	     *
+	     * When the rows of op(a) are contiguous in memory each element of y is a dot product
+	     * of a row and x, and threads work on different rows. Otherwise the columns of op(a)
+	     * are contiguous and are accumulated in y, with threads working on different parts of y.
+	     * In both cases a is read once, sequentially. Tiled and Morton matrices are read
+	     * through their layout.
+	     *
+	     * @param trans Whether to use a or its transpose
+	     * @param alpha Scalar multiplying the product
+	     * @param a The matrix
+	     * @param x A Vector or a Vector_view with as many elements as the columns of op(a)
+	     * @param beta Scalar multiplying y
+	     * @param y A Vector or a Vector_view with as many elements as the rows of op(a), updated in place
+	     *
+	     * @throws ShapeMismatchException if the sizes of x and y do not match the shape of op(a).
+	     */
+	    template <typename T, typename L, typename V1, typename V2>
+	    void gemv (const Transpose trans, const typename Matrix<T, L>::scalar_type alpha, const Matrix<T, L>& a, const V1& x,
+		    const typename Matrix<T, L>::scalar_type beta, V2&& y){
+
+		const bool transposed = trans == Transpose::transpose;
+		const size_t m = transposed ? a.get_shape().second : a.get_shape().first;
+		const size_t n = transposed ? a.get_shape().first : a.get_shape().second;
+		detail::check_size(x, n);
+		detail::check_size(y, m);
+
+		const T* a_data = a.data();
+		const T* x_data = x.data();
+		T* y_data = y.data();
+		const size_t x_stride = x.get_stride(), y_stride = y.get_stride();
+		const size_t row_grain = detail::blas_grain / (n ? n : 1) + 1;
+
+		if constexpr (std::is_same<typename L::traversal, recursive_traversal_tag>::value){
+
+		    parallel_for(0, m, row_grain, [&](size_t, size_t begin, size_t end){
+			for (size_t i = begin; i < end; ++i){
+
+			    T sum{};
+			    for (size_t j = 0; j < n; ++j)
+				sum += a_data[transposed ? a.get_layout().offset(j, i) : a.get_layout().offset(i, j)]*x_data[j*x_stride];
+			    T& target = y_data[i*y_stride];
+			    target = (beta == T{} ? T{} : beta*target) + alpha*sum;
+			}
+		    });
+		}
+		else{
+
+		    //rows of op(a) are contiguous for row major a or column major a transposed
+		    const bool contiguous_rows = std::is_same<typename L::traversal, row_traversal_tag>::value != transposed;
+		    //distance between consecutive contiguous lines of a
+		    const size_t line_stride = std::is_same<typename L::traversal, row_traversal_tag>::value ?
+			a.get_layout().row_step() : a.get_layout().column_step();
+
+		    if (contiguous_rows){
+
+			parallel_for(0, m, row_grain, [&](size_t, size_t begin, size_t end){
+			    for (size_t i = begin; i < end; ++i){
+
+				const T sum = detail::dot_kernel(a_data + i*line_stride, size_t{1}, x_data, x_stride, n);
+				T& target = y_data[i*y_stride];
+				target = (beta == T{} ? T{} : beta*target) + alpha*sum;
+			    }
+			});
+		    }
+		    else{
+
+			//each thread owns a segment of y and streams the matching part of every column
+			const size_t segment_grain = detail::blas_grain / (n ? n : 1) + 64;
+			parallel_for(0, m, segment_grain, [&](size_t, size_t begin, size_t end){
+			    detail::scal_kernel(beta, y_data + begin*y_stride, y_stride, end - begin);
+			    for (size_t j = 0; j < n; ++j)
+				detail::axpy_kernel(alpha*x_data[j*x_stride], a_data + j*line_stride + begin, size_t{1}, y_data + begin*y_stride, y_stride, end - begin);
+			});
+		    }
+		}
+	    }
+	    /**
+	     * @brief Rank one update a = alpha*x*y^T + a
+	     *
+	     * Threads update different contiguous lines of a.
+	     *
+	     * @param alpha Scalar multiplying the update
+	     * @param x A Vector or a Vector_view with as many elements as the rows of a
+	     * @param y A Vector or a Vector_view with as many elements as the columns of a
+	     * @param a The matrix, updated in place
+	     *
+	     * @throws ShapeMismatchException if the sizes of x and y do not match the shape of a.
+	     */
+	    template <typename T, typename L, typename V1, typename V2>
+	    void ger (const typename Matrix<T, L>::scalar_type alpha, const V1& x, const V2& y, Matrix<T, L>& a){
+
+		const size_t m = a.get_shape().first;
+		const size_t n = a.get_shape().second;
+		detail::check_size(x, m);
+		detail::check_size(y, n);
+
+		T* a_data = a.data();
+		const T* x_data = x.data();
+		const T* y_data = y.data();
+		const size_t x_stride = x.get_stride(), y_stride = y.get_stride();
+
+		if constexpr (std::is_same<typename L::traversal, row_traversal_tag>::value){
+
+		    parallel_for(0, m, detail::blas_grain / (n ? n : 1) + 1, [&](size_t, size_t begin, size_t end){
+			for (size_t i = begin; i < end; ++i)
+			    detail::axpy_kernel(alpha*x_data[i*x_stride], y_data, y_stride, a_data + i*a.get_layout().row_step(), size_t{1}, n);
+		    });
+		}
+		else if constexpr (std::is_same<typename L::traversal, column_traversal_tag>::value){
+
+		    parallel_for(0, n, detail::blas_grain / (m ? m : 1) + 1, [&](size_t, size_t begin, size_t end){
+			for (size_t j = begin; j < end; ++j)
+			    detail::axpy_kernel(alpha*y_data[j*y_stride], x_data, x_stride, a_data + j*a.get_layout().column_step(), size_t{1}, m);
+		    });
+		}
+		else{
+
+		    parallel_for(0, m, detail::blas_grain / (n ? n : 1) + 1, [&](size_t, size_t begin, size_t end){
+			for (size_t i = begin; i < end; ++i)
+			    for (size_t j = 0; j < n; ++j)
+				a_data[a.get_layout().offset(i, j)] += alpha*x_data[i*x_stride]*y_data[j*y_stride];
+		    });
+		}
+	    }
+	    /**
+	     * @brief Solve the triangular system op(a)*x = b
+	     *
+	     * On entry x holds b, on exit the solution. Only the given triangle of a is read.
+	     * Substitution proceeds by rows of op(a) when they are contiguous in memory and by
+	     * columns otherwise, so the matrix is always read sequentially.
+	     *
+	     * @param uplo Triangle of a holding the matrix
+	     * @param trans Whether to use a or its transpose
+	     * @param diag Whether to assume ones on the diagonal of a
+	     * @param a A square matrix
+	     * @param x A Vector or a Vector_view with as many elements as the rows of a, updated in place
+	     *
+	     * @throws ShapeMismatchException if a is not square or the size of x does not match it.
+	     */
+	    template <typename T, typename L, typename V>
+	    void trsv (const Triangle uplo, const Transpose trans, const Diagonal diag, const Matrix<T, L>& a, V&& x){
+
+		const size_t n = a.get_shape().first;
+		if (a.get_shape().second != n)
+		    throw ShapeMismatchException{};
+		detail::check_size(x, n);
+
+		const bool transposed = trans == Transpose::transpose;
+		//op(a) is lower triangular when a is lower and not transposed or upper and transposed
+		const bool lower = (uplo == Triangle::lower) != transposed;
+		const bool unit = diag == Diagonal::unit;
+		const T* a_data = a.data();
+		T* x_data = x.data();
+		const size_t x_stride = x.get_stride();
+		//element in row i and column k of op(a)
+		auto op_a = [&](size_t i, size_t k) -> const T& {
+		    return a_data[transposed ? a.get_layout().offset(k, i) : a.get_layout().offset(i, k)];
+		};
+
+		bool contiguous_rows = true;
+		size_t line_stride = 0;
+		if constexpr (!std::is_same<typename L::traversal, recursive_traversal_tag>::value){
+
+		    contiguous_rows = std::is_same<typename L::traversal, row_traversal_tag>::value != transposed;
+		    line_stride = std::is_same<typename L::traversal, row_traversal_tag>::value ?
+			a.get_layout().row_step() : a.get_layout().column_step();
+		}
+
+		for (size_t step = 0; step < n; ++step){
+
+		    const size_t i = lower ? step : n - 1 - step;
+		    //solved unknowns are [0, i) for lower systems and (i, n) for upper ones
+		    const size_t solved_begin = lower ? 0 : i + 1;
+		    const size_t solved_size = lower ? i : n - 1 - i;
+		    T& x_i = x_data[i*x_stride];
+
+		    if (contiguous_rows){
+
+			//dot form: subtract the solved part of row i of op(a)
+			if (line_stride)
+			    x_i -= detail::dot_kernel(a_data + i*line_stride + solved_begin, size_t{1}, x_data + solved_begin*x_stride, x_stride, solved_size);
+			else
+			    for (size_t k = solved_begin; k < solved_begin + solved_size; ++k)
+				x_i -= op_a(i, k)*x_data[k*x_stride];
+			if (!unit)
+			    x_i /= op_a(i, i);
+		    }
+		    else{
+
+			//axpy form: x_i is final, remove its contribution from the unsolved unknowns
+			if (!unit)
+			    x_i /= op_a(i, i);
+			const size_t unsolved_begin = lower ? i + 1 : 0;
+			const size_t unsolved_size = lower ? n - 1 - i : i;
+			detail::axpy_kernel(-x_i, a_data + i*line_stride + unsolved_begin, size_t{1}, x_data + unsolved_begin*x_stride, x_stride, unsolved_size);
+		    }
+		}
+	    }
+    }
+}
+
+#endif
@@ -0,0 +1,468 @@
+//: marsh/Distributed.hpp
+/**
+ * @file marsh/Distributed.hpp
+ */
+
+#ifndef MARSH_DISTRIBUTED_HPP
+#define MARSH_DISTRIBUTED_HPP
+
+/*
+ * Include headers
+ */
+#include <algorithm>
+#include <cstddef>
+#include <future>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "../leaq_exceptions.hpp"
+#include "Matrix.hpp"
+#include "Parallel.hpp"
+#include "Transport.hpp"
+
+namespace leaqx8664{
+
+    namespace marsh{
+
+	/////////////////////
+	// PROCESS GRID
+	/////////////////////
+
+	/**
+	 * @struct Process_grid
+	 *
+	 * @brief Arrangement of the processes of a transport in a rows x columns grid, by rows
+	 */
+	struct Process_grid{
+
+	    //! Number of rows of processes
+	    size_t rows;
+	    //! Number of columns of processes
+	    size_t columns;
+
+	    //! Get the grid row of a rank
+	    size_t row_of(const size_t rank) const noexcept { return rank / columns;}
+	    //! Get the grid column of a rank
+	    size_t column_of(const size_t rank) const noexcept { return rank % columns;}
+	    //! Get the rank at a position of the grid
+	    size_t rank_of(const size_t row, const size_t column) const noexcept { return row*columns + column;}
+	    //! Check if two grids have the same shape
+	    bool operator== (const Process_grid& other) const noexcept { return rows == other.rows && columns == other.columns;}
+	};
+
+	/////////////////////
+	// BLOCK CYCLIC HELPERS
+	/////////////////////
+	namespace detail{
+
+	    /**
+	     * Number of indices owned by process k when n indices are split in blocks of
+	     * size b dealt cyclically to p processes
+	     */
+	    inline size_t owned_count (const size_t n, const size_t b, const size_t k, const size_t p) noexcept {
+
+		const size_t n_blocks = n / b;
+		size_t count = n_blocks / p * b;
+		if (k < n_blocks % p)
+		    count += b;
+		else if (k == n_blocks % p)
+		    count += n % b;
+		return count;
+	    }
+	    /**
+	     * Global index of the local index of process k, for blocks of size b dealt to p processes
+	     */
+	    inline size_t global_index (const size_t local, const size_t b, const size_t k, const size_t p) noexcept {
+
+		return ((local / b)*p + k)*b + local % b;
+	    }
+	    /**
+	     * c += a*b for contiguous row major m x k and k x n operands and m x n result
+	     */
+	    template <typename T>
+	    void multiply_add (const T* a, const T* b, T* c, const size_t m, const size_t k, const size_t n){
+
+		parallel_for(0, m, 16, [=](size_t, size_t row_begin, size_t row_end){
+		    for (size_t i = row_begin; i < row_end; ++i)
+			for (size_t l = 0; l < k; ++l){
+
+			    const T a_il = a[i*k + l];
+			    for (size_t j = 0; j < n; ++j)
+				c[i*n + j] += a_il*b[l*n + j];
+			}
+		});
+	    }
+	}
+
+	/////////////////////
+	// DISTRIBUTED MATRIX CLASS
+	/////////////////////
+
+	/**
+	 * @class Distributed_matrix
+	 *
+	 * @brief Matrix distributed among the processes of a transport with a 2D block cyclic layout
+	 *
+	 * The matrix is split in blocks of block_rows x block_columns elements; block (I, J) is owned
+	 * by the process in row I % P and column J % Q of the P x Q process grid. Every process stores
+	 * its blocks in a local row major Matrix, in the order of their global positions.
+	 */
+	template <typename T>
+	class Distributed_matrix{
+
+	    static_assert(std::is_trivially_copyable<T>::value, "distributed elements are sent as bytes");
+
+	    public:
+
+		//! Alias for the shape of matrices and blocks
+		using shape = std::pair<size_t, size_t>;
+		//! Alias for the scalar_type of the matrix
+		using scalar_type = T;
+
+	    private:
+
+		////////////////////////////////
+		// DATA MEMBERS DECLARATIONS
+		////////////////////////////////
+		    //! Transport connecting the processes
+		    Transport* transport;
+		    //! Grid of the processes
+		    Process_grid grid;
+		    //! Shape of the whole matrix
+		    shape global_shape;
+		    //! Shape of the distribution blocks
+		    shape block_shape;
+		    //! Row and column of this process in the grid
+		    shape position;
+		    //! Elements owned by this process
+		    Matrix<T> local;
+
+	    public:
+
+		/**
+		 * Create a distributed matrix of zeros
+		 *
+		 * @param process_transport Transport connecting the processes, which must outlive the matrix
+		 * @param process_grid Grid of the processes
+		 * @param n_rows Number of rows of the whole matrix
+		 * @param n_columns Number of columns of the whole matrix
+		 * @param block_rows Number of rows of the distribution blocks
+		 * @param block_columns Number of columns of the distribution blocks
+		 *
+		 * @throws ShapeMismatchException if the grid does not match the number of processes or a block size is 0.
+		 */
+		Distributed_matrix (Transport& process_transport, const Process_grid& process_grid, const size_t n_rows, const size_t n_columns,
+		    const size_t block_rows, const size_t block_columns) :
+		    transport{&process_transport}, grid{process_grid}, global_shape{n_rows, n_columns}, block_shape{block_rows, block_columns},
+		    position{grid.columns ? grid.row_of(process_transport.get_rank()) : 0, grid.columns ? grid.column_of(process_transport.get_rank()) : 0},
+		    local{checked_local_rows(process_transport, process_grid, n_rows, block_rows, block_columns),
+			detail::owned_count(n_columns, block_columns, position.second, grid.columns)}
+		{
+		    std::fill(local.data(), local.data() + local.get_layout().storage_size(), T{});
+		}
+
+		///////////////////
+		// ACCESSORS
+		///////////////////
+		    //! Get the shape of the whole matrix
+		    shape get_shape() const noexcept { return global_shape;}
+		    //! Get the shape of the distribution blocks
+		    shape get_block_shape() const noexcept { return block_shape;}
+		    //! Get the grid of the processes
+		    const Process_grid& get_grid() const noexcept { return grid;}
+		    //! Get the row and column of this process in the grid
+		    shape get_grid_position() const noexcept { return position;}
+		    //! Get the transport connecting the processes
+		    Transport& get_transport() const noexcept { return *transport;}
+		    //! Get the elements owned by this process
+		    Matrix<T>& get_local() noexcept { return local;}
+		    //! Get the elements owned by this process
+		    const Matrix<T>& get_local() const noexcept { return local;}
+		    /**
+		     * @brief Get the rank owning an element
+		     *
+		     * @param n_row Global row of the element
+		     * @param n_column Global column of the element
+		     * @returns The rank of the owner
+		     */
+		    size_t owner(const size_t n_row, const size_t n_column) const noexcept {
+
+			return grid.rank_of(n_row / block_shape.first % grid.rows, n_column / block_shape.second % grid.columns);
+		    }
+		    //! Get the global row of a local row
+		    size_t global_row(const size_t local_row) const noexcept { return detail::global_index(local_row, block_shape.first, position.first, grid.rows);}
+		    //! Get the global column of a local column
+		    size_t global_column(const size_t local_column) const noexcept { return detail::global_index(local_column, block_shape.second, position.second, grid.columns);}
+
+		///////////////////
+		// DISTRIBUTION
+		///////////////////
+		    /**
+		     * @brief Set the local elements from a matrix available on every process
+		     *
+		     * @param global The whole matrix
+		     *
+		     * @throws ShapeMismatchException if global does not have the shape of the distributed matrix.
+		     */
+		    template <typename L>
+		    void distribute(const Matrix<T, L>& global){
+
+			if (global.get_shape() != global_shape)
+			    throw ShapeMismatchException{};
+			for (size_t i = 0; i < local.get_shape().first; ++i)
+			    for (size_t j = 0; j < local.get_shape().second; ++j)
+				local(i, j) = global(global_row(i), global_column(j));
+		    }
+		    /**
+		     * @brief Send the elements of a matrix held by root to their owners
+		     *
+		     * Must be called by every process; global is only read on root.
+		     *
+		     * @param global The whole matrix
+		     * @param root Rank holding the matrix
+		     *
+		     * @throws ShapeMismatchException if global does not have the shape of the distributed matrix on root.
+		     */
+		    template <typename L>
+		    void scatter(const Matrix<T, L>& global, const size_t root = 0){
+
+			if (transport->get_rank() == root){
+
+			    if (global.get_shape() != global_shape)
+				throw ShapeMismatchException{};
+			    for (size_t rank = 0; rank < transport->get_size(); ++rank){
+
+				const Piece piece{grid, global_shape, block_shape, rank};
+				std::vector<T> buffer(piece.n_local_rows*piece.n_local_columns);
+				for (size_t i = 0; i < piece.n_local_rows; ++i)
+				    for (size_t j = 0; j < piece.n_local_columns; ++j)
+					buffer[i*piece.n_local_columns + j] = global(detail::global_index(i, block_shape.first, piece.row, grid.rows),
+					    detail::global_index(j, block_shape.second, piece.column, grid.columns));
+				if (rank == root)
+				    std::copy(buffer.begin(), buffer.end(), local.data());
+				else
+				    transport->send(rank, buffer);
+			    }
+			}
+			else
+			    transport->receive(root, local.data(), local.get_layout().storage_size()*sizeof(T));
+		    }
+		    /**
+		     * @brief Collect the elements of the distributed matrix on root
+		     *
+		     * Must be called by every process; global is only written on root.
+		     *
+		     * @param global Matrix receiving the elements
+		     * @param root Rank collecting the elements
+		     *
+		     * @throws ShapeMismatchException if global does not have the shape of the distributed matrix on root.
+		     */
+		    template <typename L>
+		    void gather(Matrix<T, L>& global, const size_t root = 0) const {
+
+			if (transport->get_rank() != root){
+
+			    transport->send(root, local.data(), local.get_layout().storage_size()*sizeof(T));
+			    return;
+			}
+			if (global.get_shape() != global_shape)
+			    throw ShapeMismatchException{};
+			for (size_t rank = 0; rank < transport->get_size(); ++rank){
+
+			    const Piece piece{grid, global_shape, block_shape, rank};
+			    std::vector<T> buffer(piece.n_local_rows*piece.n_local_columns);
+			    if (rank == root)
+				std::copy(local.data(), local.data() + buffer.size(), buffer.begin());
+			    else
+				transport->receive(rank, buffer);
+			    for (size_t i = 0; i < piece.n_local_rows; ++i)
+				for (size_t j = 0; j < piece.n_local_columns; ++j)
+				    global(detail::global_index(i, block_shape.first, piece.row, grid.rows), detail::global_index(j, block_shape.second, piece.column, grid.columns))
+					= buffer[i*piece.n_local_columns + j];
+			}
+		    }
+
+	    private:
+
+		/**
+		 * Shape of the local part of another rank
+		 */
+		struct Piece{
+
+		    size_t row, column, n_local_rows, n_local_columns;
+
+		    Piece (const Process_grid& g, const shape& matrix_shape, const shape& blocks, const size_t rank) :
+			row{g.row_of(rank)}, column{g.column_of(rank)}, n_local_rows{detail::owned_count(matrix_shape.first, blocks.first, row, g.rows)},
+			n_local_columns{detail::owned_count(matrix_shape.second, blocks.second, column, g.columns)}
+		    {}
+		};
+
+		/**
+		 * Validate the grid and block sizes and get the number of local rows
+		 */
+		static size_t checked_local_rows (const Transport& t, const Process_grid& g, const size_t n_rows, const size_t block_rows, const size_t block_columns){
+
+		    if (g.rows*g.columns != t.get_size() || g.rows == 0 || block_rows == 0 || block_columns == 0)
+			throw ShapeMismatchException{};
+		    return detail::owned_count(n_rows, block_rows, g.row_of(t.get_rank()), g.rows);
+		}
+	};
+
+	/////////////////////
+	// DISTRIBUTED PRODUCTS
+	/////////////////////
+	namespace detail{
+
+	    /**
+	     * Check that c = a*b can be computed on the distributions of the operands: same transport
+	     * and grid, block rows of a and c, block columns of b and c and the inner blocks matching
+	     */
+	    template <typename T>
+	    void check_distributed_product (const Distributed_matrix<T>& a, const Distributed_matrix<T>& b, const Distributed_matrix<T>& c){
+
+		if (&a.get_transport() != &b.get_transport() || &a.get_transport() != &c.get_transport() || !(a.get_grid() == b.get_grid())
+		    || !(a.get_grid() == c.get_grid()) || a.get_shape().second != b.get_shape().first
+		    || c.get_shape() != std::make_pair(a.get_shape().first, b.get_shape().second)
+		    || a.get_block_shape().first != c.get_block_shape().first || b.get_block_shape().second != c.get_block_shape().second
+		    || a.get_block_shape().second != b.get_block_shape().first)
+		    throw ShapeMismatchException{};
+	    }
+	}
+	    /**
+	     * @brief Distributed product with the SUMMA algorithm
+	     *
+	     * For each block column of a and block row of b, the processes owning them broadcast the
+	     * panel along their process row and column, then every process multiplies the panels it
+	     * received into its part of c. Panel k+1 is exchanged by a separate thread while panel k is
+	     * multiplied. Must be called by every process.
+	     *
+	     * @param a Left operand
+	     * @param b Right operand
+	     * @param c Matrix receiving a*b
+	     *
+	     * @throws ShapeMismatchException if the shapes, grids or block sizes are not compatible.
+	     * @throws CommunicationException if a process fails.
+	     */
+	    template <typename T>
+	    void summa (const Distributed_matrix<T>& a, const Distributed_matrix<T>& b, Distributed_matrix<T>& c){
+
+		detail::check_distributed_product(a, b, c);
+		Transport& transport = a.get_transport();
+		const Process_grid& grid = a.get_grid();
+		const auto position = a.get_grid_position();
+		const size_t inner = a.get_shape().second, panel_width = a.get_block_shape().second;
+		const size_t m = c.get_local().get_shape().first, n = c.get_local().get_shape().second;
+		const size_t n_panels = (inner + panel_width - 1) / panel_width;
+
+		//panel k of a and of b, as contiguous row major buffers
+		auto exchange = [&](const size_t k){
+		    const size_t width = std::min(panel_width, inner - k*panel_width);
+		    std::pair<std::vector<T>, std::vector<T>> panels{std::vector<T>(m*width), std::vector<T>(width*n)};
+
+		    const size_t a_owner = k % grid.columns;
+		    if (position.second == a_owner){
+
+			const Matrix<T>& local = a.get_local();
+			const size_t first = k / grid.columns * panel_width;
+			for (size_t i = 0; i < m; ++i)
+			    std::copy(local.data() + i*local.get_shape().second + first, local.data() + i*local.get_shape().second + first + width,
+				panels.first.data() + i*width);
+			for (size_t q = 0; q < grid.columns; ++q)
+			    if (q != a_owner)
+				transport.send(grid.rank_of(position.first, q), panels.first);
+		    }
+		    else
+			transport.receive(grid.rank_of(position.first, a_owner), panels.first);
+
+		    const size_t b_owner = k % grid.rows;
+		    if (position.first == b_owner){
+
+			const T* first = b.get_local().data() + k / grid.rows * panel_width * n;
+			std::copy(first, first + width*n, panels.second.data());
+			for (size_t p = 0; p < grid.rows; ++p)
+			    if (p != b_owner)
+				transport.send(grid.rank_of(p, position.second), panels.second);
+		    }
+		    else
+			transport.receive(grid.rank_of(b_owner, position.second), panels.second);
+		    return panels;
+		};
+
+		T* result = c.get_local().data();
+		std::fill(result, result + m*n, T{});
+		if (n_panels == 0)
+		    return;
+		auto next = std::async(std::launch::async, exchange, size_t{0});
+		for (size_t k = 0; k < n_panels; ++k){
+
+		    const auto panels = next.get();
+		    if (k + 1 < n_panels)
+			next = std::async(std::launch::async, exchange, k + 1);
+		    detail::multiply_add(panels.first.data(), panels.second.data(), result, m, std::min(panel_width, inner - k*panel_width), n);
+		}
+	    }
+	    /**
+	     * @brief Distributed product with Cannon's algorithm
+	     *
+	     * On a square P x P grid, the local parts of a are shifted left by their grid row and those of
+	     * b up by their grid column, then P times every process multiplies the parts it holds into c
+	     * and passes them to its left and upper neighbours. Each shift is exchanged by a separate thread
+	     * while the parts received by the previous one are multiplied. With block cyclic distributions
+	     * the local part of a process plays the role of its block. Must be called by every process.
+	     *
+	     * @param a Left operand
+	     * @param b Right operand
+	     * @param c Matrix receiving a*b
+	     *
+	     * @throws ShapeMismatchException if the grid is not square or the shapes or block sizes are not compatible.
+	     * @throws CommunicationException if a process fails.
+	     */
+	    template <typename T>
+	    void cannon (const Distributed_matrix<T>& a, const Distributed_matrix<T>& b, Distributed_matrix<T>& c){
+
+		detail::check_distributed_product(a, b, c);
+		const Process_grid& grid = a.get_grid();
+		if (grid.rows != grid.columns)
+		    throw ShapeMismatchException{};
+		Transport& transport = a.get_transport();
+		const size_t p = a.get_grid_position().first, q = a.get_grid_position().second, side = grid.rows;
+		const size_t m = c.get_local().get_shape().first, n = c.get_local().get_shape().second;
+		//number of inner indices in the local parts coming from grid column (of a) or row (of b) s
+		auto inner_count = [&](const size_t s){ return detail::owned_count(a.get_shape().second, a.get_block_shape().second, s % side, side);};
+
+		//initial skew
+		const size_t source = (p + q) % side;
+		std::pair<std::vector<T>, std::vector<T>> parts{std::vector<T>(m*inner_count(source)), std::vector<T>(inner_count(source)*n)};
+		transport.send(grid.rank_of(p, (q + side - p) % side), a.get_local().data(), a.get_local().get_layout().storage_size()*sizeof(T));
+		transport.send(grid.rank_of((p + side - q) % side, q), b.get_local().data(), b.get_local().get_layout().storage_size()*sizeof(T));
+		transport.receive(grid.rank_of(p, source), parts.first);
+		transport.receive(grid.rank_of(source, q), parts.second);
+
+		//at step t the parts come from grid column, and row, p + q + t
+		auto shift = [&](const size_t t, const std::pair<std::vector<T>, std::vector<T>>& current){
+		    const size_t count = inner_count(p + q + t + 1);
+		    std::pair<std::vector<T>, std::vector<T>> next{std::vector<T>(m*count), std::vector<T>(count*n)};
+		    transport.send(grid.rank_of(p, (q + side - 1) % side), current.first);
+		    transport.send(grid.rank_of((p + side - 1) % side, q), current.second);
+		    transport.receive(grid.rank_of(p, (q + 1) % side), next.first);
+		    transport.receive(grid.rank_of((p + 1) % side, q), next.second);
+		    return next;
+		};
+
+		T* result = c.get_local().data();
+		std::fill(result, result + m*n, T{});
+		for (size_t t = 0; t < side; ++t){
+
+		    std::future<std::pair<std::vector<T>, std::vector<T>>> next;
+		    if (t + 1 < side)
+			next = std::async(std::launch::async, shift, t, std::cref(parts));
+		    detail::multiply_add(parts.first.data(), parts.second.data(), result, m, inner_count(p + q + t), n);
+		    if (t + 1 < side)
+			parts = next.get();
+		}
+	    }
+    }
+}
+
+#endif
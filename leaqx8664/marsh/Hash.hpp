@@ -0,0 +1,247 @@
+//: marsh/Hash.hpp
+/**
+ * @file marsh/Hash.hpp
+ */
+
+#ifndef MARSH_HASH_HPP
+#define MARSH_HASH_HPP
+
+/*
+ * Include headers
+ */
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "Parallel.hpp"
+
+namespace leaqx8664{
+
+    namespace marsh{
+
+	/////////////////////
+	// CONTENT HASH
+	/////////////////////
+	namespace detail{
+
+	    //! Multipliers of the xxHash64 mixing functions
+	    constexpr std::uint64_t hash_prime_1 = 0x9E3779B185EBCA87ULL;
+	    constexpr std::uint64_t hash_prime_2 = 0xC2B2AE3D27D4EB4FULL;
+	    constexpr std::uint64_t hash_prime_3 = 0x165667B19E3779F9ULL;
+	    constexpr std::uint64_t hash_prime_4 = 0x85EBCA77C2B2AE63ULL;
+	    constexpr std::uint64_t hash_prime_5 = 0x27D4EB2F165667C5ULL;
+	    //! Number of elements hashed by each task of hash_elements
+	    constexpr size_t hash_chunk = size_t{1} << 14;
+
+	    inline std::uint64_t rotate_left(const std::uint64_t x, const int bits) noexcept {
+
+		return (x << bits) | (x >> (64 - bits));
+	    }
+	    inline std::uint64_t hash_round(std::uint64_t accumulator, const std::uint64_t lane) noexcept {
+
+		accumulator += lane*hash_prime_2;
+		return rotate_left(accumulator, 31)*hash_prime_1;
+	    }
+	    inline std::uint64_t hash_merge(std::uint64_t accumulator, const std::uint64_t value) noexcept {
+
+		accumulator ^= hash_round(0, value);
+		return accumulator*hash_prime_1 + hash_prime_4;
+	    }
+
+	    /**
+	     * Streaming xxHash64 style hash of 64 bit words. Words are consumed by 32 byte stripes, whose
+	     * four words go to four fixed accumulators so that the dependency chains overlap; the words of
+	     * an incomplete last stripe are mixed in the digest.
+	     */
+	    class Hash_state{
+
+		//! The four accumulators
+		std::uint64_t accumulators[4];
+		//! Words of the incomplete stripe
+		std::uint64_t pending[4] = {};
+		//! Number of words mixed so far
+		std::uint64_t n_words = 0;
+
+		//! Mix a whole stripe in the accumulators
+		void mix_stripe (const std::uint64_t* stripe) noexcept {
+
+		    accumulators[0] = hash_round(accumulators[0], stripe[0]);
+		    accumulators[1] = hash_round(accumulators[1], stripe[1]);
+		    accumulators[2] = hash_round(accumulators[2], stripe[2]);
+		    accumulators[3] = hash_round(accumulators[3], stripe[3]);
+		}
+
+		public:
+
+		    explicit Hash_state (const std::uint64_t seed = 0) noexcept :
+			accumulators{seed + hash_prime_1 + hash_prime_2, seed + hash_prime_2, seed, seed - hash_prime_1}
+		    {}
+		    //! Mix a word in the hash
+		    void update (const std::uint64_t word) noexcept {
+
+			pending[n_words % 4] = word;
+			if (++n_words % 4 == 0)
+			    mix_stripe(pending);
+		    }
+		    /**
+		     * Mix n_stripes stripes in the hash, as 4*n_stripes calls to update would; word(s, k) returns
+		     * word k of stripe s. The accumulators are kept in locals so the four lanes stay in registers.
+		     */
+		    template <typename Word>
+		    void update_stripes (const size_t n_stripes, Word word) noexcept {
+
+			if (n_words % 4 != 0){
+
+			    for (size_t s = 0; s < n_stripes; ++s)
+				for (size_t k = 0; k < 4; ++k)
+				    update(word(s, k));
+			    return;
+			}
+			std::uint64_t a0 = accumulators[0], a1 = accumulators[1], a2 = accumulators[2], a3 = accumulators[3];
+			for (size_t s = 0; s < n_stripes; ++s){
+
+			    a0 = hash_round(a0, word(s, 0));
+			    a1 = hash_round(a1, word(s, 1));
+			    a2 = hash_round(a2, word(s, 2));
+			    a3 = hash_round(a3, word(s, 3));
+			}
+			accumulators[0] = a0;
+			accumulators[1] = a1;
+			accumulators[2] = a2;
+			accumulators[3] = a3;
+			n_words += 4*n_stripes;
+		    }
+		    //! Get the hash of the words mixed so far
+		    std::uint64_t digest () const noexcept {
+
+			std::uint64_t h = rotate_left(accumulators[0], 1) + rotate_left(accumulators[1], 7)
+			    + rotate_left(accumulators[2], 12) + rotate_left(accumulators[3], 18);
+			for (const auto accumulator : accumulators)
+			    h = hash_merge(h, accumulator);
+			h += n_words*8 + hash_prime_5;
+			for (size_t i = 0; i < n_words % 4; ++i){
+
+			    h ^= hash_round(0, pending[i]);
+			    h = rotate_left(h, 27)*hash_prime_1 + hash_prime_4;
+			}
+			h ^= h >> 33;
+			h *= hash_prime_2;
+			h ^= h >> 29;
+			h *= hash_prime_3;
+			h ^= h >> 32;
+			return h;
+		    }
+	    };
+
+	    /**
+	     * Mix the object representation of a value in a hash. Floating point zeros are
+	     * normalised so that values comparing equal have the same hash.
+	     */
+	    template <typename T>
+	    T normalised_value (const T& value) noexcept {
+
+		static_assert(std::has_unique_object_representations<T>::value || std::is_same<T, float>::value || std::is_same<T, double>::value,
+		    "content hashes need types whose equal values have the same bytes");
+		if constexpr (std::is_floating_point<T>::value)
+		    return value == T{} ? T{} : value;
+		else
+		    return value;
+	    }
+	    template <typename T>
+	    void hash_value (Hash_state& state, const T& value) noexcept {
+
+		const T normalised = normalised_value(value);
+		constexpr size_t n_words = (sizeof(T) + 7) / 8;
+		std::uint64_t words[n_words] = {};
+		std::memcpy(words, &normalised, sizeof(T));
+		for (size_t i = 0; i < n_words; ++i)
+		    state.update(words[i]);
+	    }
+	    /**
+	     * Mix n consecutive elements in a hash. Elements whose size divides 32 bytes are packed
+	     * in whole stripes, the remaining ones are mixed one by one.
+	     */
+	    template <typename T>
+	    void hash_range (Hash_state& state, const T* elements, const size_t n) noexcept {
+
+		size_t i = 0;
+		if constexpr (32 % sizeof(T) == 0){
+
+		    constexpr size_t per_word = 8 / sizeof(T);
+		    const size_t n_stripes = n / (4*per_word);
+		    state.update_stripes(n_stripes, [elements](size_t s, size_t k){
+			std::uint64_t word;
+			if constexpr (std::is_same<T, double>::value){
+
+			    //-0.0 is the only double equal to 0.0 with other bits: a select keeps the loop branch free
+			    std::memcpy(&word, elements + 4*s + k, 8);
+			    word = word == std::uint64_t{1} << 63 ? 0 : word;
+			}
+			else{
+
+			    T normalised[per_word];
+			    for (size_t e = 0; e < per_word; ++e)
+				normalised[e] = normalised_value(elements[(4*s + k)*per_word + e]);
+			    std::memcpy(&word, normalised, 8);
+			}
+			return word;
+		    });
+		    i = n_stripes*4*per_word;
+		}
+		for (; i < n; ++i)
+		    hash_value(state, elements[i]);
+	    }
+	}
+	    /**
+	     * @brief Hash an array of elements with the shape of the matrix storing them
+	     *
+	     * The elements are split in fixed chunks hashed in parallel, then the chunk hashes
+	     * are combined with the shape, so the result does not depend on the number of threads.
+	     *
+	     * @param elements Pointer to the elements
+	     * @param n_elements Number of elements
+	     * @param shape Shape mixed in the hash
+	     * @returns The 64 bit hash
+	     */
+	    template <typename T>
+	    std::uint64_t hash_elements (const T* elements, const size_t n_elements, const std::pair<size_t, size_t>& shape){
+
+		const size_t n_chunks = (n_elements + detail::hash_chunk - 1) / detail::hash_chunk;
+		std::vector<std::uint64_t> chunk_hashes(n_chunks);
+		parallel_for(0, n_chunks, 4, [&](size_t, size_t chunk_begin, size_t chunk_end){
+		    for (size_t c = chunk_begin; c < chunk_end; ++c){
+
+			detail::Hash_state state{c};
+			const size_t end = std::min(n_elements, (c + 1)*detail::hash_chunk);
+			detail::hash_range(state, elements + c*detail::hash_chunk, end - c*detail::hash_chunk);
+			chunk_hashes[c] = state.digest();
+		    }
+		});
+
+		detail::Hash_state state{shape.first};
+		state.update(shape.second);
+		for (const auto chunk_hash : chunk_hashes)
+		    state.update(chunk_hash);
+		return state.digest();
+	    }
+	    /**
+	     * @brief Combine two hashes
+	     *
+	     * @param seed The hash to update
+	     * @param value The hash to mix in
+	     * @returns The combined hash, which depends on the order of the arguments
+	     */
+	    inline std::uint64_t hash_combine (const std::uint64_t seed, const std::uint64_t value) noexcept {
+
+		detail::Hash_state state{seed};
+		state.update(value);
+		return state.digest();
+	    }
+    }
+}
+
+#endif
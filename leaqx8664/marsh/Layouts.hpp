@@ -0,0 +1,361 @@
+//: marsh/Layouts.hpp
+/**
+ * @file marsh/Layouts.hpp
+ */
+
+#ifndef MARSH_LAYOUTS_HPP
+#define MARSH_LAYOUTS_HPP
+
+/*
+ * Include headers
+ */
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+namespace leaqx8664{
+
+    namespace marsh{
+
+	/////////////////////
+	// TRAVERSAL TAGS
+	/////////////////////
+	    //! Tag for layouts whose rows are contiguous in memory
+	    struct row_traversal_tag {};
+	    //! Tag for layouts whose columns are contiguous in memory
+	    struct column_traversal_tag {};
+	    //! Tag for layouts that keep square sub-blocks contiguous and favour recursive algorithms
+	    struct recursive_traversal_tag {};
+
+	/////////////////////
+	// ROW MAJOR LAYOUT
+	/////////////////////
+	/**
+	 * @class Row_major
+	 *
+	 * @brief Storage policy placing the elements of a matrix row after row
+	 *
+	 * This is the default layout of Matrix objects: the element in row r and column c
+	 * is stored at offset r*n_columns + c.
+	 */
+	class Row_major{
+
+	    //! Number of columns of the matrix
+	    size_t n_columns;
+	    //! Number of stored elements
+	    size_t n_elements;
+
+	    public:
+
+		//! Traversal order that visits the storage sequentially
+		using traversal = row_traversal_tag;
+		//! True if the storage contains elements that are not part of the matrix
+		static constexpr bool padded = false;
+
+		/**
+		 * @brief Build the layout for a matrix with the given shape
+		 *
+		 * @param matrix_shape Pair of number of rows and number of columns
+		 */
+		explicit Row_major (const std::pair<size_t, size_t>& matrix_shape) noexcept :
+		    n_columns{matrix_shape.second}, n_elements{matrix_shape.first*matrix_shape.second}
+		{}
+		/**
+		 * @brief Number of elements to allocate for the matrix
+		 *
+		 * @returns The size of the storage
+		 */
+		size_t storage_size() const noexcept { return n_elements;}
+		/**
+		 * @brief Position in storage of the element in row n_row and column n_column
+		 *
+		 * @param n_row Row of the element
+		 * @param n_column Column of the element
+		 * @returns The offset of the element from the beginning of the storage
+		 */
+		size_t offset (const size_t n_row, const size_t n_column) const noexcept {
+
+		    return n_columns*n_row + n_column;
+		}
+		/**
+		 * @brief Position in storage of the element with the given sequential index
+		 *
+		 * Sequential indices count the elements of the matrix by rows.
+		 *
+		 * @param index Sequential index of the element
+		 * @returns The offset of the element from the beginning of the storage
+		 */
+		size_t offset (const size_t index) const noexcept { return index;}
+		//! Distance in storage between an element and the one below it
+		size_t row_step() const noexcept { return n_columns;}
+		//! Distance in storage between an element and the one on its right
+		size_t column_step() const noexcept { return 1;}
+	};
+
+	/////////////////////
+	// COLUMN MAJOR LAYOUT
+	/////////////////////
+	/**
+	 * @class Column_major
+	 *
+	 * @brief Storage policy placing the elements of a matrix column after column
+	 *
+	 * The element in row r and column c is stored at offset c*n_rows + r, so that
+	 * algorithms sweeping columns read contiguous memory.
+	 */
+	class Column_major{
+
+	    //! Number of rows of the matrix
+	    size_t n_rows;
+	    //! Number of columns of the matrix
+	    size_t n_columns;
+
+	    public:
+
+		//! Traversal order that visits the storage sequentially
+		using traversal = column_traversal_tag;
+		//! True if the storage contains elements that are not part of the matrix
+		static constexpr bool padded = false;
+
+		/**
+		 * @brief Build the layout for a matrix with the given shape
+		 *
+		 * @param matrix_shape Pair of number of rows and number of columns
+		 */
+		explicit Column_major (const std::pair<size_t, size_t>& matrix_shape) noexcept :
+		    n_rows{matrix_shape.first}, n_columns{matrix_shape.second}
+		{}
+		/**
+		 * @brief Number of elements to allocate for the matrix
+		 *
+		 * @returns The size of the storage
+		 */
+		size_t storage_size() const noexcept { return n_rows*n_columns;}
+		/**
+		 * @brief Position in storage of the element in row n_row and column n_column
+		 *
+		 * @param n_row Row of the element
+		 * @param n_column Column of the element
+		 * @returns The offset of the element from the beginning of the storage
+		 */
+		size_t offset (const size_t n_row, const size_t n_column) const noexcept {
+
+		    return n_rows*n_column + n_row;
+		}
+		/**
+		 * @brief Position in storage of the element with the given sequential index
+		 *
+		 * Sequential indices count the elements of the matrix by rows.
+		 *
+		 * @param index Sequential index of the element
+		 * @returns The offset of the element from the beginning of the storage
+		 */
+		size_t offset (const size_t index) const noexcept {
+
+		    return offset(index / n_columns, index % n_columns);
+		}
+		//! Distance in storage between an element and the one below it
+		size_t row_step() const noexcept { return 1;}
+		//! Distance in storage between an element and the one on its right
+		size_t column_step() const noexcept { return n_rows;}
+	};
+
+	/////////////////////
+	// TILED LAYOUT
+	/////////////////////
+	/**
+	 * @class Tiled
+	 *
+	 * @brief Storage policy splitting the matrix in square tiles stored contiguously
+	 *
+	 * Tiles of size Tile x Tile are stored one after the other by rows, and the elements
+	 * inside each tile are stored by rows too. The last row and column of tiles are padded,
+	 * so the storage holds a whole number of tiles.
+	 */
+	template <size_t Tile = 32>
+	class Tiled{
+
+	    static_assert(Tile > 0, "Tile size must be positive");
+
+	    //! Number of columns of the matrix
+	    size_t n_columns;
+	    //! Number of tiles in each row of tiles
+	    size_t tiles_per_row;
+	    //! Number of tiles in each column of tiles
+	    size_t tiles_per_column;
+
+	    public:
+
+		//! Traversal order that visits the storage sequentially
+		using traversal = recursive_traversal_tag;
+		//! True if the storage contains elements that are not part of the matrix
+		static constexpr bool padded = true;
+		//! Side of the square sub-blocks stored contiguously
+		static constexpr size_t leaf_size = Tile;
+
+		/**
+		 * @brief Build the layout for a matrix with the given shape
+		 *
+		 * @param matrix_shape Pair of number of rows and number of columns
+		 */
+		explicit Tiled (const std::pair<size_t, size_t>& matrix_shape) noexcept :
+		    n_columns{matrix_shape.second},
+		    tiles_per_row{(matrix_shape.second + Tile - 1) / Tile},
+		    tiles_per_column{(matrix_shape.first + Tile - 1) / Tile}
+		{}
+		/**
+		 * @brief Number of elements to allocate for the matrix
+		 *
+		 * @returns The size of the storage, including padding
+		 */
+		size_t storage_size() const noexcept { return tiles_per_row*tiles_per_column*Tile*Tile;}
+		/**
+		 * @brief Position in storage of the element in row n_row and column n_column
+		 *
+		 * @param n_row Row of the element
+		 * @param n_column Column of the element
+		 * @returns The offset of the element from the beginning of the storage
+		 */
+		size_t offset (const size_t n_row, const size_t n_column) const noexcept {
+
+		    return ((n_row / Tile)*tiles_per_row + n_column / Tile)*Tile*Tile + (n_row % Tile)*Tile + n_column % Tile;
+		}
+		/**
+		 * @brief Position in storage of the element with the given sequential index
+		 *
+		 * Sequential indices count the elements of the matrix by rows.
+		 *
+		 * @param index Sequential index of the element
+		 * @returns The offset of the element from the beginning of the storage
+		 */
+		size_t offset (const size_t index) const noexcept {
+
+		    return offset(index / n_columns, index % n_columns);
+		}
+	};
+
+	/////////////////////
+	// MORTON LAYOUT
+	/////////////////////
+	/**
+	 * @class Morton
+	 *
+	 * @brief Storage policy following the Morton (Z-order) curve
+	 *
+	 * The offset of an element is obtained interleaving the bits of its column index (even bits)
+	 * with the bits of its row index (odd bits), so every aligned square block whose side is a power
+	 * of two is contiguous in memory. Each dimension is padded to the next power of two; when the
+	 * padded dimensions differ, the high bits of the larger index are placed after the interleaved ones.
+	 */
+	class Morton{
+
+	    //! Number of columns of the matrix
+	    size_t n_columns;
+	    //! Number of interleaved bits for each index
+	    unsigned interleaved_bits;
+	    //! Number of elements to allocate
+	    size_t n_elements;
+
+	    /**
+	     * Number of bits needed to represent indices in [0, n)
+	     */
+	    static unsigned index_bits (const size_t n) noexcept {
+
+		unsigned bits = 0;
+		while ((size_t{1} << bits) < n)
+		    ++bits;
+		return bits;
+	    }
+	    /**
+	     * Spread the lower 32 bits of x to the even bits of the result
+	     */
+	    static uint64_t spread_bits (uint64_t x) noexcept {
+
+		x &= 0x00000000FFFFFFFFULL;
+		x = (x | (x << 16)) & 0x0000FFFF0000FFFFULL;
+		x = (x | (x << 8)) & 0x00FF00FF00FF00FFULL;
+		x = (x | (x << 4)) & 0x0F0F0F0F0F0F0F0FULL;
+		x = (x | (x << 2)) & 0x3333333333333333ULL;
+		x = (x | (x << 1)) & 0x5555555555555555ULL;
+		return x;
+	    }
+
+	    public:
+
+		//! Traversal order that visits the storage sequentially
+		using traversal = recursive_traversal_tag;
+		//! True if the storage contains elements that are not part of the matrix
+		static constexpr bool padded = true;
+		//! Number of bits of the side of the leaves
+		static constexpr unsigned leaf_bits = 5;
+		//! Side of the square sub-blocks under which recursive algorithms stop splitting
+		static constexpr size_t leaf_size = size_t{1} << leaf_bits;
+
+		/**
+		 * @brief Build the layout for a matrix with the given shape
+		 *
+		 * @param matrix_shape Pair of number of rows and number of columns
+		 */
+		explicit Morton (const std::pair<size_t, size_t>& matrix_shape) noexcept :
+		    n_columns{matrix_shape.second}
+		{
+		    const unsigned row_bits = index_bits(matrix_shape.first);
+		    const unsigned column_bits = index_bits(matrix_shape.second);
+		    interleaved_bits = row_bits < column_bits ? row_bits : column_bits;
+		    n_elements = (matrix_shape.first && matrix_shape.second) ? size_t{1} << (row_bits + column_bits) : 0;
+		}
+		/**
+		 * @brief Number of elements to allocate for the matrix
+		 *
+		 * @returns The size of the storage, including padding
+		 */
+		size_t storage_size() const noexcept { return n_elements;}
+		/**
+		 * @brief Position in storage of the element in row n_row and column n_column
+		 *
+		 * @param n_row Row of the element
+		 * @param n_column Column of the element
+		 * @returns The offset of the element from the beginning of the storage
+		 */
+		size_t offset (const size_t n_row, const size_t n_column) const noexcept {
+
+		    const size_t low_mask = (size_t{1} << interleaved_bits) - 1;
+		    return ((spread_bits(n_row & low_mask) << 1) | spread_bits(n_column & low_mask))
+			| (((n_row | n_column) >> interleaved_bits) << (2*interleaved_bits));
+		}
+		/**
+		 * @brief Position in storage of the element with the given sequential index
+		 *
+		 * Sequential indices count the elements of the matrix by rows.
+		 *
+		 * @param index Sequential index of the element
+		 * @returns The offset of the element from the beginning of the storage
+		 */
+		size_t offset (const size_t index) const noexcept {
+
+		    return offset(index / n_columns, index % n_columns);
+		}
+		/**
+		 * @brief Check if the aligned leaf_size x leaf_size blocks are stored contiguously
+		 *
+		 * This holds unless one of the padded dimensions is smaller than leaf_size. The element
+		 * in row n_row and column n_column is then stored at leaf_offset(n_row, n_column) from
+		 * the offset of the first element of its leaf.
+		 */
+		bool contiguous_leaves() const noexcept { return interleaved_bits >= leaf_bits;}
+		/**
+		 * @brief Position of an element inside the aligned leaf containing it
+		 *
+		 * @param n_row Row of the element
+		 * @param n_column Column of the element
+		 * @returns The offset of the element from the first element of its leaf
+		 */
+		static size_t leaf_offset (const size_t n_row, const size_t n_column) noexcept {
+
+		    return (spread_bits(n_row & (leaf_size - 1)) << 1) | spread_bits(n_column & (leaf_size - 1));
+		}
+	};
+    }
+}
+
+#endif
@@ -9,12 +9,20 @@
 /*
  * Include headers
  */
+#include <atomic>
+#include <cstdint>
 #include <memory>
 #include <utility>
 #include <iterator>
+#include <vector>
 #include <iostream>
+#include <algorithm>
+#include <type_traits>
 
 #include "../leaq_exceptions.hpp"
+#include "Layouts.hpp"
+#include "Vector.hpp"
+#include "Hash.hpp"
 
 namespace leaqx8664{
 
@@ -31,10 +39,16 @@ namespace leaqx8664{
 	 *
 	 * A matrix is a 2 dimensional array with scalar elements for which common mathematical operations
 	 * such as summation and multiplication are defined through the overloading of operators.
+	 * The Layout policy decides where each element is placed in memory (see marsh/Layouts.hpp),
+	 * the default one stores the matrix by rows.
 	 */
-	template <typename T>
+	template <typename T, typename Layout = Row_major>
 	class Matrix{
 
+		//! Matrices with different layouts can access each other storage
+		template <typename, typename>
+		friend class Matrix;
+
 	    public:
 
 		/**
@@ -52,6 +66,8 @@ namespace leaqx8664{
 		using block = Matrix_block;
 		//! Alias for scalar_type used in the matrix
 		using scalar_type = T;
+		//! Alias for the storage layout of the matrix
+		using layout_type = Layout;
 
 	    private:
 
@@ -64,6 +80,31 @@ namespace leaqx8664{
 		    std::pair<size_t, size_t> matrix_shape; 
 		    //! Maximum valid index in this matrix
 		    size_t max_index;
+		    //! Mapping from matrix positions to storage offsets
+		    layout_type matrix_layout;
+		    //! True if rows and columns are equally spaced in memory, as row and column views need
+		    static constexpr bool strided_layout = std::is_same<Layout, Row_major>::value || std::is_same<Layout, Column_major>::value;
+		    //! Content hash stored by seal(), meaningful when hash_sealed is set
+		    mutable std::atomic<std::uint64_t> content_hash{0};
+		    //! True from seal() to the next member giving write access to the elements
+		    mutable std::atomic<bool> hash_sealed{false};
+
+		    /**
+		     * Drop the sealed content hash: called by every member giving write access to the elements
+		     */
+		    void invalidate_hash() noexcept {
+
+			hash_sealed.store(false, std::memory_order_relaxed);
+		    }
+
+		    /**
+		     * Allocate the storage for n elements. Padded layouts get value initialized
+		     * storage so that padding never differs between matrices.
+		     */
+		    static scalar_type* allocate(const size_t n){
+
+			return layout_type::padded ? new T[n]() : new T[n];
+		    }
 
 		////////////////////////////////
 		// ITERATORS DECLATRATION
@@ -107,18 +148,20 @@ namespace leaqx8664{
 		     * @param n_columns Number of columns in the matrix
 		     */
 		    Matrix (const size_t n_rows, const size_t n_columns) :
-			elements{new T[n_rows*n_columns + 1]}, matrix_shape{n_rows, n_columns}, max_index{n_rows*n_columns - 1} 
+			elements{allocate(layout_type{shape{n_rows, n_columns}}.storage_size())}, matrix_shape{n_rows, n_columns}, max_index{n_rows*n_columns - 1},
+			matrix_layout{matrix_shape}
 		    {}
 		    /**
 		     * Copy constructor for Matrix objects
 		     *
 		     * @param other Matrix object to copy from
 		     */
-		    Matrix (const Matrix<T>& other) :
-			elements{new T[other.max_index + 1]}, matrix_shape{other.matrix_shape}, max_index{other.max_index} 
+		    Matrix (const Matrix& other) :
+			elements{new T[other.matrix_layout.storage_size()]}, matrix_shape{other.matrix_shape}, max_index{other.max_index},
+			matrix_layout{other.matrix_layout}
 		    {
 			//copy elements of the given matrix in the new one
-			for (size_t i = 0U; i <= max_index; ++i)
+			for (size_t i = 0U; i < matrix_layout.storage_size(); ++i)
 			    elements[i] = other.elements[i];
 		    }
 		    /**
@@ -126,12 +169,51 @@ namespace leaqx8664{
 		     *
 		     * @param other Matrix object to move from
 		     */
-		    Matrix (Matrix<T>&& other) :
-			matrix_shape{std::move(other.matrix_shape)}, max_index{other.max_index}, elements{other.elements.release()}
+		    Matrix (Matrix&& other) :
+			elements{other.elements.release()}, matrix_shape{std::move(other.matrix_shape)}, max_index{other.max_index},
+			matrix_layout{other.matrix_layout}
 		    {}
 		    /**
-		     * ADD CONSTRUCTORS USING MATRIX SUBLOCKS
-		    */
+		     * @brief Conversion constructor between layouts
+		     *
+		     * Create a matrix with the same shape and elements of the given one but stored
+		     * with this matrix layout. The copy proceeds by square blocks so that both the source
+		     * and the destination storage are accessed with good locality, even when one of them
+		     * is the transpose of the other in memory.
+		     *
+		     * @param other Matrix object to convert
+		     */
+		    template <typename Other_layout>
+		    explicit Matrix (const Matrix<T, Other_layout>& other) :
+			Matrix(other.matrix_shape.first, other.matrix_shape.second)
+		    {
+			constexpr size_t block_side = 32;
+			for (size_t row_block = 0; row_block < matrix_shape.first; row_block += block_side){
+
+			    const size_t row_end = std::min(row_block + block_side, matrix_shape.first);
+			    for (size_t column_block = 0; column_block < matrix_shape.second; column_block += block_side){
+
+				const size_t column_end = std::min(column_block + block_side, matrix_shape.second);
+				for (size_t i = row_block; i < row_end; ++i)
+				    for (size_t j = column_block; j < column_end; ++j)
+					elements[matrix_layout.offset(i, j)] = other.elements[other.matrix_layout.offset(i, j)];
+			    }
+			}
+		    }
+		    /**
+		     * @brief Create a matrix from a block of another one
+		     *
+		     * The new matrix has the shape of the block and a copy of its elements.
+		     *
+		     * @param source The block to copy from
+		     */
+		    explicit Matrix (const block& source) :
+			Matrix(source.get_shape().first, source.get_shape().second)
+		    {
+			for (size_t i = 0; i < matrix_shape.first; ++i)
+			    for (size_t j = 0; j < matrix_shape.second; ++j)
+				elements[matrix_layout.offset(i, j)] = source(i, j);
+		    }
 
 
 		///////////////////
@@ -159,16 +241,18 @@ namespace leaqx8664{
 		     *
 		     * @param other The matrix to copy from
 		     */
-		    Matrix<T>& operator= (const Matrix<T>& other){
+		    Matrix& operator= (const Matrix& other){
 		    
-			elements.reset(new T[other.max_index + 1]);
+			elements.reset(new T[other.matrix_layout.storage_size()]);
 			matrix_shape = other.matrix_shape;
 			max_index = other.max_index;
+			matrix_layout = other.matrix_layout;
 
-			for (size_t i = 0; i <= max_index; ++i){
+			for (size_t i = 0; i < matrix_layout.storage_size(); ++i){
 			
 			    elements[i] = other.elements[i];
 			}
+			invalidate_hash();
 			return *this;
 		    }
 		    /*
@@ -178,11 +262,13 @@ namespace leaqx8664{
 		     *
 		     * @param other An rvalue reference to a matrix to move from.
 		     */
-		    Matrix<T>& operator= (Matrix<T>&& other){
+		    Matrix& operator= (Matrix&& other){
 		    
 			elements = std::move(other.elements);
 			matrix_shape = std::move(other.matrix_shape);
 			max_index = other.max_index;
+			matrix_layout = other.matrix_layout;
+			invalidate_hash();
 			return *this;
 		    }
 		    ///////////////////
@@ -204,8 +290,9 @@ namespace leaqx8664{
 			 */
 			scalar_type& operator()(const size_t n_row, const size_t n_column){
 			
+			    invalidate_hash();
 			    if (n_row < matrix_shape.first && n_column < matrix_shape.second)
-				return elements[matrix_shape.second*n_row + n_column];
+				return elements[matrix_layout.offset(n_row, n_column)];
 			    throw IndexOutOfBoundsException{};
 			}
 			/**
@@ -222,8 +309,9 @@ namespace leaqx8664{
 			 */
 			scalar_type& operator()(const size_t index){
 			
+			    invalidate_hash();
 			    if (index <= max_index)
-				return elements[index];
+				return elements[matrix_layout.offset(index)];
 			    throw IndexOutOfBoundsException{};
 			}
 			/**
@@ -243,7 +331,7 @@ namespace leaqx8664{
 			const scalar_type& operator()(const size_t n_row, const size_t n_column) const {
 			
 			    if (n_row < matrix_shape.first && n_column < matrix_shape.second)
-				return elements[matrix_shape.second*n_row + n_column];
+				return elements[matrix_layout.offset(n_row, n_column)];
 			    throw IndexOutOfBoundsException{};
 			}
 			/**
@@ -261,7 +349,7 @@ namespace leaqx8664{
 			const scalar_type& operator()(const size_t index) const {
 			
 			    if (index <= max_index)
-				return elements[index];
+				return elements[matrix_layout.offset(index)];
 			    throw IndexOutOfBoundsException{};
 			}
 
@@ -272,17 +360,35 @@ namespace leaqx8664{
 			 * @breif Overloading of operator== for Matrix class
 			 *
 			 * Check if this and the given matrix have the same shape and the same elements.
+			 * When both matrices have the same layout and have been sealed (see seal()),
+			 * different hashes answer without scanning the elements.
 			 *
 			 * @param other The matrix to compare with this one.
 			 * @returns True if have the same shape and elements, false otherwise.
 			 */
-			bool operator== (const Matrix<scalar_type>& other) const noexcept {
+			template <typename Other_layout>
+			bool operator== (const Matrix<scalar_type, Other_layout>& other) const noexcept {
 
 			    if (matrix_shape.first == other.matrix_shape.first && matrix_shape.second == other.matrix_shape.second){
-				for (size_t i = 0; i <= max_index; ++i){
+				if constexpr (std::is_same<layout_type, Other_layout>::value){
 
-				    if ((*this)(i) != other(i))
+				    if (hash_sealed.load(std::memory_order_acquire) && other.hash_sealed.load(std::memory_order_acquire)
+					&& content_hash.load(std::memory_order_relaxed) != other.content_hash.load(std::memory_order_relaxed))
 					return false;
+
+				    //same layout: the storages can be compared sequentially
+				    for (size_t i = 0; i < matrix_layout.storage_size(); ++i){
+
+					if (elements[i] != other.elements[i])
+					    return false;
+				    }
+				}
+				else{
+
+				    for (size_t i = 0; i < matrix_shape.first; ++i)
+					for (size_t j = 0; j < matrix_shape.second; ++j)
+					    if (elements[matrix_layout.offset(i, j)] != other.elements[other.matrix_layout.offset(i, j)])
+						return false;
 				}
 				return true;
 			    }
@@ -297,7 +403,8 @@ namespace leaqx8664{
 			 * @param other The matrix to compare with this one.
 			 * @returns True if have different shape or different elements, false otherwise.
 			 */
-			bool operator!= (const Matrix<scalar_type>& other) const noexcept {
+			template <typename Other_layout>
+			bool operator!= (const Matrix<scalar_type, Other_layout>& other) const noexcept {
 
 			    return !operator==(other);
 			}
@@ -314,14 +421,14 @@ namespace leaqx8664{
 		     *
 		     * @returns An iterator to the first element in the matrix
 		     */
-		    iterator begin() { return iterator{elements.get(), max_index};}
+		    iterator begin() { invalidate_hash(); return iterator{elements.get(), matrix_layout, matrix_shape.second, max_index};}
 		    /**
 		     * @brief Get an iterator representing the terminal element in the structure.
 		     *
 		     * Returns an iterator pointing to the terminal element of the matrix.
 		     *
 		     */
-		    iterator end() { return iterator{nullptr, 0};}
+		    iterator end() { return iterator{nullptr, matrix_layout, 0, 0};}
 		    /**
 		     * @brief Get a const iterator to the beginning of the structure
 		     *
@@ -330,14 +437,14 @@ namespace leaqx8664{
 		     *
 		     * @returns A const iterator to the first element in the matrix
 		     */
-		    const_iterator begin() const { return const_iterator{elements.get(), max_index};}
+		    const_iterator begin() const { return const_iterator{elements.get(), matrix_layout, matrix_shape.second, max_index};}
 		    /**
 		     * @brief Get a const iterator representing the terminal element in the structure.
 		     *
 		     * Returns a const iterator pointing to the terminal element of the matrix.
 		     *
 		     */
-		    const_iterator end() const { return const_iterator{nullptr, 0};}
+		    const_iterator end() const { return const_iterator{nullptr, matrix_layout, 0, 0};}
 		    /**
 		     * @brief Get a const iterator to the beginning of the structure
 		     *
@@ -346,14 +453,14 @@ namespace leaqx8664{
 		     *
 		     * @returns A const iterator to the first element in the matrix
 		     */
-		    const_iterator cbegin() const { return const_iterator{elements.get(), max_index};}
+		    const_iterator cbegin() const { return const_iterator{elements.get(), matrix_layout, matrix_shape.second, max_index};}
 		    /**
 		     * @brief Get a const iterator representing the terminal element in the structure.
 		     *
 		     * Returns a const iterator pointing to the terminal element of the matrix.
 		     *
 		     */
-		    const_iterator cend() const { return const_iterator{nullptr, 0};}
+		    const_iterator cend() const { return const_iterator{nullptr, matrix_layout, 0, 0};}
 
 		
 		///////////////////
@@ -388,6 +495,173 @@ namespace leaqx8664{
 			return max_index;
 		    }
 
+		///////////////////
+		// STORAGE ACCESS MEMBERS
+		///////////////////
+		    /**
+		     * @brief Get the layout of a Matrix
+		     *
+		     * Returns the object mapping matrix positions to offsets in the storage.
+		     *
+		     * @returns The layout of the Matrix
+		     */
+		    const layout_type& get_layout() const noexcept {
+
+			return matrix_layout;
+		    }
+		    /**
+		     * @brief Get a pointer to the storage of a Matrix
+		     *
+		     * Elements are placed in the storage as dictated by the layout: the element in
+		     * row i and column j is data()[get_layout().offset(i, j)]. No bounds checking is
+		     * performed on accesses through the returned pointer.
+		     *
+		     * @returns A pointer to the first element of the storage
+		     */
+		    scalar_type* data() noexcept { invalidate_hash(); return elements.get();}
+		    /**
+		     * @brief Get a const pointer to the storage of a Matrix
+		     *
+		     * @returns A const pointer to the first element of the storage
+		     */
+		    const scalar_type* data() const noexcept { return elements.get();}
+
+		///////////////////
+		// CONTENT HASH
+		///////////////////
+		    /**
+		     * @brief Get the content hash of the Matrix
+		     *
+		     * The hash mixes the shape and the storage of the matrix and is computed in parallel
+		     * from the current elements on every call. Matrices with the same layout and equal
+		     * elements have the same hash; floating point zeros of both signs hash the same.
+		     *
+		     * @returns The 64 bit content hash
+		     */
+		    std::uint64_t get_hash() const {
+
+			return hash_elements(elements.get(), matrix_layout.storage_size(), matrix_shape);
+		    }
+		    /**
+		     * @brief Store the content hash of a Matrix that will not be modified anymore
+		     *
+		     * Once sealed, comparisons with another sealed matrix of the same layout start from
+		     * the stored hashes. Members giving write access to the elements (non const operator(),
+		     * data(), begin(), row(), column() or an access through a block) and assignments drop
+		     * the seal, but writes through views, iterators, pointers or references obtained before
+		     * sealing are not detected: the caller must not make them. Copies are not sealed.
+		     *
+		     * @returns The 64 bit content hash
+		     */
+		    std::uint64_t seal() const {
+
+			const std::uint64_t hash = get_hash();
+			content_hash.store(hash, std::memory_order_relaxed);
+			hash_sealed.store(true, std::memory_order_release);
+			return hash;
+		    }
+		    /**
+		     * @brief Check if the Matrix is sealed
+		     *
+		     * @returns True if seal() was called and no write access was given since
+		     */
+		    bool is_sealed() const noexcept { return hash_sealed.load(std::memory_order_acquire);}
+
+		///////////////////
+		// BLOCK ACCESS MEMBER
+		///////////////////
+		    /**
+		     * @brief Get a block of the Matrix
+		     *
+		     * The block refers to the elements of this matrix, which must outlive it.
+		     *
+		     * @param first_row Row of the matrix where the block starts
+		     * @param first_column Column of the matrix where the block starts
+		     * @param n_rows Number of rows in the block
+		     * @param n_columns Number of columns in the block
+		     * @returns The block of the matrix
+		     *
+		     * @throws IndexOutOfBoundsException if the block does not fit in the matrix.
+		     */
+		    block get_block(const size_t first_row, const size_t first_column, const size_t n_rows, const size_t n_columns){
+
+			return block{*this, first_row, first_column, n_rows, n_columns};
+		    }
+
+		///////////////////
+		// ROW AND COLUMN VIEWS
+		///////////////////
+		    /**
+		     * @brief Get a view on a row of the Matrix
+		     *
+		     * The view refers to the storage of the matrix, so changes made through it
+		     * are visible in the matrix. Only layouts where rows are equally spaced in
+		     * memory (Row_major and Column_major) support views.
+		     *
+		     * @param n_row The index of the row
+		     * @returns A strided view on the row
+		     *
+		     * @throws IndexOutOfBoundsException if the given index is not valid.
+		     */
+		    Vector_view<scalar_type> row(const size_t n_row){
+
+			static_assert(strided_layout, "row views are only supported for Row_major and Column_major layouts");
+			invalidate_hash();
+			if (n_row < matrix_shape.first)
+			    return Vector_view<scalar_type>{elements.get() + matrix_layout.offset(n_row, 0), matrix_shape.second, matrix_layout.column_step()};
+			throw IndexOutOfBoundsException{};
+		    }
+		    /**
+		     * @brief Get a read only view on a row of the Matrix
+		     *
+		     * @param n_row The index of the row
+		     * @returns A strided read only view on the row
+		     *
+		     * @throws IndexOutOfBoundsException if the given index is not valid.
+		     */
+		    Vector_view<const scalar_type> row(const size_t n_row) const {
+
+			static_assert(strided_layout, "row views are only supported for Row_major and Column_major layouts");
+			if (n_row < matrix_shape.first)
+			    return Vector_view<const scalar_type>{elements.get() + matrix_layout.offset(n_row, 0), matrix_shape.second, matrix_layout.column_step()};
+			throw IndexOutOfBoundsException{};
+		    }
+		    /**
+		     * @brief Get a view on a column of the Matrix
+		     *
+		     * The view refers to the storage of the matrix, so changes made through it
+		     * are visible in the matrix. Only layouts where columns are equally spaced in
+		     * memory (Row_major and Column_major) support views.
+		     *
+		     * @param n_column The index of the column
+		     * @returns A strided view on the column
+		     *
+		     * @throws IndexOutOfBoundsException if the given index is not valid.
+		     */
+		    Vector_view<scalar_type> column(const size_t n_column){
+
+			static_assert(strided_layout, "column views are only supported for Row_major and Column_major layouts");
+			invalidate_hash();
+			if (n_column < matrix_shape.second)
+			    return Vector_view<scalar_type>{elements.get() + matrix_layout.offset(0, n_column), matrix_shape.first, matrix_layout.row_step()};
+			throw IndexOutOfBoundsException{};
+		    }
+		    /**
+		     * @brief Get a read only view on a column of the Matrix
+		     *
+		     * @param n_column The index of the column
+		     * @returns A strided read only view on the column
+		     *
+		     * @throws IndexOutOfBoundsException if the given index is not valid.
+		     */
+		    Vector_view<const scalar_type> column(const size_t n_column) const {
+
+			static_assert(strided_layout, "column views are only supported for Row_major and Column_major layouts");
+			if (n_column < matrix_shape.second)
+			    return Vector_view<const scalar_type>{elements.get() + matrix_layout.offset(0, n_column), matrix_shape.first, matrix_layout.row_step()};
+			throw IndexOutOfBoundsException{};
+		    }
+
 
 	    private:
 
@@ -400,6 +674,16 @@ namespace leaqx8664{
 			scalar_type* current_position;
 			//! Number of elements left to visit
 			size_t remaining;
+			//! Pointer to the beginning of the storage
+			scalar_type* storage;
+			//! Layout of the iterated matrix
+			layout_type layout;
+			//! Number of columns of the iterated matrix
+			size_t n_columns;
+			//! Row of the current element
+			size_t current_row;
+			//! Column of the current element
+			size_t current_column;
 
 			public:
 			    
@@ -409,10 +693,13 @@ namespace leaqx8664{
 			     * Create a Matrix_iterator that points to the given matrix element.
 			     *
 			     * @param target First element in the iteration through the matrix
+			     * @param matrix_layout Layout of the iterated matrix
+			     * @param columns Number of columns of the iterated matrix
 			     * @param max Maximum offset from the starting element
 			     */
-			    Matrix_iterator (scalar_type* target, size_t max) :
-				current_position{target}, remaining{max + 1}
+			    Matrix_iterator (scalar_type* target, const layout_type& matrix_layout, size_t columns, size_t max) :
+				current_position{target}, remaining{max + 1}, storage{target}, layout{matrix_layout},
+				n_columns{columns}, current_row{0}, current_column{0}
 			    {}
 			    /**
 			     * @brief Operator++ for the Matrix_iterator class
@@ -427,10 +714,22 @@ namespace leaqx8664{
 			    
 				if (remaining > 0){
 				
-				    //decrement remaining, when different from zero increment 
-				    //the current_position while when reaches zero set to
-				    //nullptr
-				    (--remaining && ++current_position) || (current_position = nullptr);
+				    //decrement remaining, when it reaches zero set current_position to nullptr
+				    if (!--remaining){
+
+					current_position = nullptr;
+					return *this;
+				    }
+				    if (++current_column == n_columns){
+
+					current_column = 0;
+					++current_row;
+				    }
+				    //rows are contiguous in row major storage, other layouts compute the offset
+				    if (std::is_same<typename layout_type::traversal, row_traversal_tag>::value)
+					++current_position;
+				    else
+					current_position = storage + layout.offset(current_row, current_column);
 				    return *this;
 				}
 
@@ -504,8 +803,323 @@ namespace leaqx8664{
 				return Matrix_iterator::operator*();
 			    }
 		    };
+
+	    public:
+
+		//////////////////
+		// MATRIX BLOCK CLASS
+		//////////////////
+		    class Matrix_block{
+
+			//! Matrix the block belongs to
+			Matrix* matrix;
+			//! Row of the matrix where the block starts
+			size_t first_row;
+			//! Column of the matrix where the block starts
+			size_t first_column;
+			//! Number of rows and columns in the block
+			shape block_shape;
+
+			public:
+
+			    /**
+			     * @brief Constructor for a Matrix_block
+			     *
+			     * Create the block of n_rows x n_columns elements of target starting at
+			     * row first and column first_col.
+			     *
+			     * @param target Matrix the block belongs to
+			     * @param first Row of the matrix where the block starts
+			     * @param first_col Column of the matrix where the block starts
+			     * @param n_rows Number of rows in the block
+			     * @param n_columns Number of columns in the block
+			     *
+			     * @throws IndexOutOfBoundsException if the block does not fit in the matrix.
+			     */
+			    Matrix_block (Matrix& target, const size_t first, const size_t first_col, const size_t n_rows, const size_t n_columns) :
+				matrix{&target}, first_row{first}, first_column{first_col}, block_shape{n_rows, n_columns}
+			    {
+				if (first + n_rows > target.matrix_shape.first || first_col + n_columns > target.matrix_shape.second)
+				    throw IndexOutOfBoundsException{};
+			    }
+			    /**
+			     * @brief Operator() for the Matrix_block class
+			     *
+			     * Return a reference to the element in row n_row and column n_column of
+			     * the block. Indexing starts at 0 from the top left corner of the block.
+			     *
+			     * @param n_row Row of the desired element.
+			     * @param n_column Column of the desired element.
+			     * @returns A reference to the desired element in the matrix.
+			     *
+			     * @throws IndexOutOfBoundsException if one of the given indices is not valid.
+			     */
+			    scalar_type& operator()(const size_t n_row, const size_t n_column) const {
+
+				matrix->invalidate_hash();
+				if (n_row < block_shape.first && n_column < block_shape.second)
+				    return matrix->elements[matrix->matrix_layout.offset(first_row + n_row, first_column + n_column)];
+				throw IndexOutOfBoundsException{};
+			    }
+			    //! Get the shape of the block
+			    shape get_shape() const noexcept { return block_shape;}
+			    //! Get the row of the matrix where the block starts
+			    size_t get_first_row() const noexcept { return first_row;}
+			    //! Get the column of the matrix where the block starts
+			    size_t get_first_column() const noexcept { return first_column;}
+			    //! Get the matrix the block belongs to
+			    Matrix& get_matrix() const noexcept { return *matrix;}
+		    };
 	};
 	
+	////////////////
+	// MULTIPLICATION KERNELS
+	////////////////
+	namespace detail{
+
+	    /**
+	     * Accumulate in result the product of the blocks [row_begin, row_end)x[inner_begin, inner_end) of lhs
+	     * and [inner_begin, inner_end)x[column_begin, column_end) of rhs, visiting rows in the outer loop.
+	     */
+	    template <typename T, typename L1, typename L2, typename L3>
+	    void multiply_block_by_rows (const Matrix<T, L1>& lhs, const Matrix<T, L2>& rhs, Matrix<T, L3>& result,
+		    size_t row_begin, size_t row_end, size_t inner_begin, size_t inner_end, size_t column_begin, size_t column_end){
+
+		const T* a = lhs.data();
+		const T* b = rhs.data();
+		T* c = result.data();
+		for (size_t i = row_begin; i < row_end; ++i)
+		    for (size_t k = inner_begin; k < inner_end; ++k){
+
+			const T a_ik = a[lhs.get_layout().offset(i, k)];
+			for (size_t j = column_begin; j < column_end; ++j)
+			    c[result.get_layout().offset(i, j)] += a_ik*b[rhs.get_layout().offset(k, j)];
+		    }
+	    }
+	    /**
+	     * Accumulate in result the product of the blocks [row_begin, row_end)x[inner_begin, inner_end) of lhs
+	     * and [inner_begin, inner_end)x[column_begin, column_end) of rhs, visiting columns in the outer loop.
+	     */
+	    template <typename T, typename L1, typename L2, typename L3>
+	    void multiply_block_by_columns (const Matrix<T, L1>& lhs, const Matrix<T, L2>& rhs, Matrix<T, L3>& result,
+		    size_t row_begin, size_t row_end, size_t inner_begin, size_t inner_end, size_t column_begin, size_t column_end){
+
+		const T* a = lhs.data();
+		const T* b = rhs.data();
+		T* c = result.data();
+		for (size_t j = column_begin; j < column_end; ++j)
+		    for (size_t k = inner_begin; k < inner_end; ++k){
+
+			const T b_kj = b[rhs.get_layout().offset(k, j)];
+			for (size_t i = row_begin; i < row_end; ++i)
+			    c[result.get_layout().offset(i, j)] += a[lhs.get_layout().offset(i, k)]*b_kj;
+		    }
+	    }
+	    /**
+	     * Split a range of the given size in two parts, the first one being a multiple of leaf elements
+	     */
+	    inline size_t split_point (const size_t size, const size_t leaf){
+
+		return ((size/2 + leaf - 1) / leaf)*leaf;
+	    }
+	    /**
+	     * Check if the block of the given size starting at (row, column) is stored by rows,
+	     * setting stride to the distance between its rows. Layouts are assumed not to.
+	     */
+	    template <typename L>
+	    bool leaf_stride (const L&, size_t, size_t, size_t, size_t, size_t&){
+
+		return false;
+	    }
+	    inline bool leaf_stride (const Row_major& layout, size_t, size_t, size_t, size_t, size_t& stride){
+
+		stride = layout.row_step();
+		return true;
+	    }
+	    template <size_t Tile>
+	    bool leaf_stride (const Tiled<Tile>&, size_t row, size_t column, size_t rows, size_t columns, size_t& stride){
+
+		stride = Tile;
+		return row % Tile + rows <= Tile && column % Tile + columns <= Tile;
+	    }
+	    /**
+	     * Call f(i, j, offset) for the elements of the block of the given size starting at (row, column)
+	     */
+	    template <typename L, typename F>
+	    void for_leaf_offsets (const L& layout, size_t row, size_t column, size_t rows, size_t columns, F f){
+
+		for (size_t i = 0; i < rows; ++i)
+		    for (size_t j = 0; j < columns; ++j)
+			f(i, j, layout.offset(row + i, column + j));
+	    }
+	    /**
+	     * Blocks inside one aligned leaf of a Morton layout are addressed from the start of the leaf,
+	     * with offsets separable in a row part and a column part
+	     */
+	    template <typename F>
+	    void for_leaf_offsets (const Morton& layout, size_t row, size_t column, size_t rows, size_t columns, F f){
+
+		constexpr size_t leaf = Morton::leaf_size;
+		if (!layout.contiguous_leaves() || row % leaf + rows > leaf || column % leaf + columns > leaf){
+
+		    for (size_t i = 0; i < rows; ++i)
+			for (size_t j = 0; j < columns; ++j)
+			    f(i, j, layout.offset(row + i, column + j));
+		    return;
+		}
+		const size_t base = layout.offset(row - row % leaf, column - column % leaf);
+		size_t row_part[leaf], column_part[leaf];
+		for (size_t i = 0; i < rows; ++i)
+		    row_part[i] = base + Morton::leaf_offset(row + i, 0);
+		for (size_t j = 0; j < columns; ++j)
+		    column_part[j] = Morton::leaf_offset(0, column + j);
+		for (size_t i = 0; i < rows; ++i)
+		    for (size_t j = 0; j < columns; ++j)
+			f(i, j, row_part[i] + column_part[j]);
+	    }
+	    /**
+	     * Pointer to the block of the given size starting at (row, column) stored by rows with the
+	     * returned stride: the block itself if the layout stores it by rows, else a copy in buffer
+	     */
+	    template <typename T, typename L>
+	    const T* leaf_operand (const Matrix<T, L>& matrix, size_t row, size_t column, size_t rows, size_t columns, T* buffer, size_t& stride){
+
+		if (leaf_stride(matrix.get_layout(), row, column, rows, columns, stride))
+		    return matrix.data() + matrix.get_layout().offset(row, column);
+
+		const T* data = matrix.data();
+		for_leaf_offsets(matrix.get_layout(), row, column, rows, columns, [&](size_t i, size_t j, size_t offset){ buffer[i*columns + j] = data[offset];});
+		stride = columns;
+		return buffer;
+	    }
+	    /**
+	     * Accumulate in the rows x columns block c the product of the rows x inner block a and the
+	     * inner x columns block b, all of them stored by rows with the given strides
+	     */
+	    template <typename T>
+	    void multiply_leaf (const T* a, size_t a_stride, const T* b, size_t b_stride, T* c, size_t c_stride, size_t rows, size_t inner, size_t columns){
+
+		for (size_t i = 0; i < rows; ++i){
+
+		    const T* a_row = a + i*a_stride;
+		    T* c_row = c + i*c_stride;
+		    for (size_t k = 0; k < inner; ++k){
+
+			const T a_ik = a_row[k];
+			const T* b_row = b + k*b_stride;
+			for (size_t j = 0; j < columns; ++j)
+			    c_row[j] += a_ik*b_row[j];
+		    }
+		}
+	    }
+	    /**
+	     * Divide and conquer multiplication: the largest of the three ranges is halved until all of them
+	     * fit in a leaf of the layout. Splits fall on multiples of the leaf size, so every leaf lies inside
+	     * one contiguous tile or Z-block of the result; its base pointer is computed once and the leaf
+	     * product runs on blocks stored by rows, packing in workspace (3 leaves) the ones that are not.
+	     */
+	    template <typename T, typename L1, typename L2, typename L3>
+	    void multiply_recursive (const Matrix<T, L1>& lhs, const Matrix<T, L2>& rhs, Matrix<T, L3>& result,
+		    size_t row_begin, size_t row_end, size_t inner_begin, size_t inner_end, size_t column_begin, size_t column_end, T* workspace){
+
+		constexpr size_t leaf = L3::leaf_size;
+		const size_t rows = row_end - row_begin;
+		const size_t inner = inner_end - inner_begin;
+		const size_t columns = column_end - column_begin;
+
+		if (rows == 0 || inner == 0 || columns == 0){
+
+		    return;
+		}
+		else if (rows <= leaf && inner <= leaf && columns <= leaf){
+
+		    size_t a_stride, b_stride, c_stride;
+		    const T* a = leaf_operand(lhs, row_begin, inner_begin, rows, inner, workspace, a_stride);
+		    const T* b = leaf_operand(rhs, inner_begin, column_begin, inner, columns, workspace + leaf*leaf, b_stride);
+		    if (leaf_stride(result.get_layout(), row_begin, column_begin, rows, columns, c_stride)){
+
+			multiply_leaf(a, a_stride, b, b_stride, result.data() + result.get_layout().offset(row_begin, column_begin), c_stride, rows, inner, columns);
+		    }
+		    else{
+
+			T* c = workspace + 2*leaf*leaf;
+			T* data = result.data();
+			for_leaf_offsets(result.get_layout(), row_begin, column_begin, rows, columns, [&](size_t i, size_t j, size_t offset){ c[i*columns + j] = data[offset];});
+			multiply_leaf(a, a_stride, b, b_stride, c, columns, rows, inner, columns);
+			for_leaf_offsets(result.get_layout(), row_begin, column_begin, rows, columns, [&](size_t i, size_t j, size_t offset){ data[offset] = c[i*columns + j];});
+		    }
+		}
+		else if (rows >= inner && rows >= columns){
+
+		    const size_t middle = row_begin + split_point(rows, leaf);
+		    multiply_recursive(lhs, rhs, result, row_begin, middle, inner_begin, inner_end, column_begin, column_end, workspace);
+		    multiply_recursive(lhs, rhs, result, middle, row_end, inner_begin, inner_end, column_begin, column_end, workspace);
+		}
+		else if (columns >= inner){
+
+		    const size_t middle = column_begin + split_point(columns, leaf);
+		    multiply_recursive(lhs, rhs, result, row_begin, row_end, inner_begin, inner_end, column_begin, middle, workspace);
+		    multiply_recursive(lhs, rhs, result, row_begin, row_end, inner_begin, inner_end, middle, column_end, workspace);
+		}
+		else{
+
+		    const size_t middle = inner_begin + split_point(inner, leaf);
+		    multiply_recursive(lhs, rhs, result, row_begin, row_end, inner_begin, middle, column_begin, column_end, workspace);
+		    multiply_recursive(lhs, rhs, result, row_begin, row_end, middle, inner_end, column_begin, column_end, workspace);
+		}
+	    }
+	    /*
+	     * Pick the loop order matching the traversal of the result layout
+	     */
+	    template <typename T, typename L1, typename L2, typename L3>
+	    void multiply (const Matrix<T, L1>& lhs, const Matrix<T, L2>& rhs, Matrix<T, L3>& result, row_traversal_tag){
+
+		multiply_block_by_rows(lhs, rhs, result, 0, lhs.get_shape().first, 0, lhs.get_shape().second, 0, rhs.get_shape().second);
+	    }
+	    template <typename T, typename L1, typename L2, typename L3>
+	    void multiply (const Matrix<T, L1>& lhs, const Matrix<T, L2>& rhs, Matrix<T, L3>& result, column_traversal_tag){
+
+		multiply_block_by_columns(lhs, rhs, result, 0, lhs.get_shape().first, 0, lhs.get_shape().second, 0, rhs.get_shape().second);
+	    }
+	    template <typename T, typename L1, typename L2, typename L3>
+	    void multiply (const Matrix<T, L1>& lhs, const Matrix<T, L2>& rhs, Matrix<T, L3>& result, recursive_traversal_tag){
+
+		constexpr size_t leaf = L3::leaf_size;
+		std::vector<T> workspace(3*leaf*leaf);
+		multiply_recursive(lhs, rhs, result, 0, lhs.get_shape().first, 0, lhs.get_shape().second, 0, rhs.get_shape().second, workspace.data());
+	    }
+	}
+
+	////////////////
+	// OPERATOR* FOR THE MATRIX CLASS
+	////////////////
+	    /**
+	     * @brief Overloading of operator* for Matrix class
+	     *
+	     * Compute the row by column product of the given matrices. The result has the
+	     * layout of the left operand and the loop order is chosen accordingly: row major
+	     * results are computed by rows, column major ones by columns, while tiled and
+	     * Morton results use a recursive divide and conquer product whose leaves are
+	     * contiguous blocks of the storage.
+	     *
+	     * @param lhs The left operand
+	     * @param rhs The right operand
+	     * @returns The product lhs*rhs
+	     *
+	     * @throws ShapeMismatchException if the columns of lhs are not as many as the rows of rhs.
+	     */
+	    template <typename T, typename L1, typename L2>
+	    Matrix<T, L1> operator* (const Matrix<T, L1>& lhs, const Matrix<T, L2>& rhs){
+
+		if (lhs.get_shape().second != rhs.get_shape().first)
+		    throw ShapeMismatchException{};
+
+		Matrix<T, L1> result{lhs.get_shape().first, rhs.get_shape().second};
+		std::fill(result.data(), result.data() + result.get_layout().storage_size(), T{});
+		detail::multiply(lhs, rhs, result, typename L1::traversal{});
+		return result;
+	    }
+
 	////////////////
 	// OPERATOR PUT TO FOR THE MATRIX CLASS      
 	////////////////
@@ -519,12 +1133,12 @@ namespace leaqx8664{
 	     * @param os The target std::ostream
 	     * @param matrix The Matrix object to redirect
 	     */
-	    template <typename T>
-	    std::ostream& operator<< ( std::ostream& os, const Matrix<T>& matrix){
+	    template <typename T, typename Layout>
+	    std::ostream& operator<< ( std::ostream& os, const Matrix<T, Layout>& matrix){
 	    
 		os << "[ ";
 		size_t i = 0;
-		typename Matrix<T>::shape matrix_shape = matrix.get_shape();
+		typename Matrix<T, Layout>::shape matrix_shape = matrix.get_shape();
 		for (auto& x : matrix){
 		    os << x;
 		    if (++i % matrix_shape.second == 0 && i/matrix_shape.second != matrix_shape.first)
@@ -0,0 +1,880 @@
+//: marsh/Packed.hpp
+/**
+ * @file marsh/Packed.hpp
+ */
+
+#ifndef MARSH_PACKED_HPP
+#define MARSH_PACKED_HPP
+
+/*
+ * Include headers
+ */
+#include <memory>
+#include <utility>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <type_traits>
+
+#include "../leaq_exceptions.hpp"
+#include "Layouts.hpp"
+#include "Parallel.hpp"
+#include "Vector.hpp"
+#include "Matrix.hpp"
+#include "Blas.hpp"
+
+namespace leaqx8664{
+
+    namespace marsh{
+
+	/////////////////////
+	// PACKED STORAGE BASE CLASS
+	/////////////////////
+
+	/**
+	 * @class Packed_storage
+	 *
+	 * @brief Storage shared by matrices that only keep part of their elements
+	 *
+	 * The class owns the array of stored elements and provides the members that do not depend
+	 * on which elements are stored. Derived classes map positions to offsets in the array.
+	 */
+	template <typename T>
+	class Packed_storage{
+
+	    public:
+
+		//! Alias for the shape of the matrix
+		using shape = std::pair<size_t, size_t>;
+		//! Alias for scalar_type used in the matrix
+		using scalar_type = T;
+
+	    protected:
+
+		////////////////////////////////
+		// DATA MEMBERS DECLARATIONS
+		////////////////////////////////
+		    //! Pointer to array of stored elements
+		    std::unique_ptr<scalar_type[]> elements;
+		    //! Pair of the number of rows and columns in the matrix
+		    shape matrix_shape;
+		    //! Maximum valid index in this matrix
+		    size_t max_index;
+		    //! Number of stored elements
+		    size_t storage_size;
+
+		/**
+		 * Allocate value initialized storage for n_elements elements of a matrix with the given shape
+		 */
+		Packed_storage (const shape& packed_shape, const size_t n_elements) :
+		    elements{new T[n_elements]()}, matrix_shape{packed_shape}, max_index{packed_shape.first*packed_shape.second - 1},
+		    storage_size{n_elements}
+		{}
+		//! Copy constructor
+		Packed_storage (const Packed_storage& other) :
+		    elements{new T[other.storage_size]}, matrix_shape{other.matrix_shape}, max_index{other.max_index},
+		    storage_size{other.storage_size}
+		{
+		    std::copy(other.elements.get(), other.elements.get() + storage_size, elements.get());
+		}
+		//! Move constructor
+		Packed_storage (Packed_storage&& other) = default;
+		//! Copy assignment
+		Packed_storage& operator= (const Packed_storage& other){
+
+		    elements.reset(new T[other.storage_size]);
+		    matrix_shape = other.matrix_shape;
+		    max_index = other.max_index;
+		    storage_size = other.storage_size;
+		    std::copy(other.elements.get(), other.elements.get() + storage_size, elements.get());
+		    return *this;
+		}
+		//! Move assignment
+		Packed_storage& operator= (Packed_storage&& other) = default;
+		//! Destructor
+		~Packed_storage() = default;
+
+		/**
+		 * Reference to a zero element, returned by const accesses outside the stored part
+		 */
+		static const scalar_type& zero() noexcept {
+
+		    static const scalar_type value{};
+		    return value;
+		}
+
+	    public:
+
+		/**
+		 * @brief Get the shape of the matrix
+		 *
+		 * @returns The shape of the matrix
+		 */
+		shape get_shape() const noexcept { return matrix_shape;}
+		/**
+		 * @brief Get the maximum sequential index for this matrix object
+		 *
+		 * @returns The maximum valid sequential index
+		 */
+		size_t get_max_index() const noexcept { return max_index;}
+		/**
+		 * @brief Get the number of stored elements
+		 *
+		 * @returns The size of the storage
+		 */
+		size_t get_storage_size() const noexcept { return storage_size;}
+		//! Get a pointer to the stored elements
+		scalar_type* data() noexcept { return elements.get();}
+		//! Get a const pointer to the stored elements
+		const scalar_type* data() const noexcept { return elements.get();}
+	};
+
+	/////////////////////
+	// PACKED SYMMETRIC MATRIX CLASS
+	/////////////////////
+
+	/**
+	 * @class Packed_symmetric
+	 *
+	 * @brief Square symmetric matrix storing only its lower triangle
+	 *
+	 * The n(n+1)/2 elements of the lower triangle are stored by rows: the element in row i and
+	 * column j <= i is at offset i(i+1)/2 + j. Accesses to the upper triangle are redirected to the
+	 * symmetric element, so a Packed_symmetric can be used wherever the elements of a Matrix are
+	 * read through operator().
+	 */
+	template <typename T>
+	class Packed_symmetric : public Packed_storage<T>{
+
+	    using base = Packed_storage<T>;
+
+	    public:
+
+		using typename base::shape;
+		using typename base::scalar_type;
+
+		/**
+		 * Create a symmetric matrix of order n with all elements equal to zero
+		 *
+		 * @param n Number of rows and columns of the matrix
+		 */
+		explicit Packed_symmetric (const size_t n) :
+		    base{shape{n, n}, n*(n + 1)/2}
+		{}
+		/**
+		 * Create a symmetric matrix from the lower triangle of a square Matrix
+		 *
+		 * @param other The matrix to read
+		 *
+		 * @throws ShapeMismatchException if other is not square.
+		 */
+		template <typename L>
+		explicit Packed_symmetric (const Matrix<T, L>& other) :
+		    Packed_symmetric(other.get_shape().first)
+		{
+		    if (other.get_shape().second != other.get_shape().first)
+			throw ShapeMismatchException{};
+		    for (size_t i = 0; i < this->matrix_shape.first; ++i)
+			for (size_t j = 0; j <= i; ++j)
+			    this->elements[offset(i, j)] = other(i, j);
+		}
+
+		/**
+		 * @brief Position in storage of the element in row n_row and column n_column
+		 *
+		 * @param n_row Row of the element
+		 * @param n_column Column of the element
+		 * @returns The offset of the element, or of its symmetric one, in the storage
+		 */
+		static size_t offset (const size_t n_row, const size_t n_column) noexcept {
+
+		    return n_row >= n_column ? n_row*(n_row + 1)/2 + n_column : n_column*(n_column + 1)/2 + n_row;
+		}
+		/**
+		 * @brief Overloading of operator() for the Packed_symmetric class
+		 *
+		 * Return a reference to the element in row n_row and column n_column. Elements
+		 * (i,j) and (j,i) are the same stored element.
+		 *
+		 * @param n_row Row of the desired element.
+		 * @param n_column Column of the desired element.
+		 * @returns A reference to the desired element in the matrix.
+		 *
+		 * @throws IndexOutOfBoundsException if one of the given indices is not valid.
+		 */
+		scalar_type& operator()(const size_t n_row, const size_t n_column){
+
+		    if (n_row < this->matrix_shape.first && n_column < this->matrix_shape.second)
+			return this->elements[offset(n_row, n_column)];
+		    throw IndexOutOfBoundsException{};
+		}
+		//! Const version of operator()(n_row, n_column)
+		const scalar_type& operator()(const size_t n_row, const size_t n_column) const {
+
+		    if (n_row < this->matrix_shape.first && n_column < this->matrix_shape.second)
+			return this->elements[offset(n_row, n_column)];
+		    throw IndexOutOfBoundsException{};
+		}
+		//! Access the element with the given sequential index, counted by rows
+		scalar_type& operator()(const size_t index){
+
+		    if (index <= this->max_index)
+			return (*this)(index / this->matrix_shape.second, index % this->matrix_shape.second);
+		    throw IndexOutOfBoundsException{};
+		}
+		//! Const version of operator()(index)
+		const scalar_type& operator()(const size_t index) const {
+
+		    if (index <= this->max_index)
+			return (*this)(index / this->matrix_shape.second, index % this->matrix_shape.second);
+		    throw IndexOutOfBoundsException{};
+		}
+		/**
+		 * @brief Get the full Matrix represented by this object
+		 *
+		 * @returns A row major Matrix with the same elements
+		 */
+		Matrix<T> unpack() const {
+
+		    Matrix<T> result{this->matrix_shape.first, this->matrix_shape.second};
+		    for (size_t i = 0; i < this->matrix_shape.first; ++i)
+			for (size_t j = 0; j < this->matrix_shape.second; ++j)
+			    result(i, j) = this->elements[offset(i, j)];
+		    return result;
+		}
+	};
+
+	/////////////////////
+	// PACKED TRIANGULAR MATRIX CLASS
+	/////////////////////
+
+	/**
+	 * @class Packed_triangular
+	 *
+	 * @brief Square triangular matrix storing only its non zero triangle
+	 *
+	 * The n(n+1)/2 elements of the triangle are stored by rows. Const accesses outside the
+	 * triangle return zero, while non const ones throw, since those elements cannot be changed.
+	 */
+	template <typename T>
+	class Packed_triangular : public Packed_storage<T>{
+
+	    using base = Packed_storage<T>;
+
+	    //! Triangle holding the elements
+	    Triangle uplo;
+
+	    public:
+
+		using typename base::shape;
+		using typename base::scalar_type;
+
+		/**
+		 * Create a triangular matrix of order n with all elements equal to zero
+		 *
+		 * @param n Number of rows and columns of the matrix
+		 * @param triangle Triangle holding the elements
+		 */
+		Packed_triangular (const size_t n, const Triangle triangle) :
+		    base{shape{n, n}, n*(n + 1)/2}, uplo{triangle}
+		{}
+		/**
+		 * Create a triangular matrix from a triangle of a square Matrix
+		 *
+		 * @param other The matrix to read
+		 * @param triangle Triangle of other to read
+		 *
+		 * @throws ShapeMismatchException if other is not square.
+		 */
+		template <typename L>
+		Packed_triangular (const Matrix<T, L>& other, const Triangle triangle) :
+		    Packed_triangular(other.get_shape().first, triangle)
+		{
+		    if (other.get_shape().second != other.get_shape().first)
+			throw ShapeMismatchException{};
+		    for (size_t i = 0; i < this->matrix_shape.first; ++i)
+			for (size_t j = 0; j < this->matrix_shape.second; ++j)
+			    if (stored(i, j))
+				this->elements[offset(i, j)] = other(i, j);
+		}
+
+		//! Get the triangle holding the elements
+		Triangle get_triangle() const noexcept { return uplo;}
+		//! Check whether the element in row n_row and column n_column is stored
+		bool stored (const size_t n_row, const size_t n_column) const noexcept {
+
+		    return uplo == Triangle::lower ? n_column <= n_row : n_column >= n_row;
+		}
+		/**
+		 * @brief Position in storage of a stored element
+		 *
+		 * @param n_row Row of the element
+		 * @param n_column Column of the element
+		 * @returns The offset of the element in the storage
+		 */
+		size_t offset (const size_t n_row, const size_t n_column) const noexcept {
+
+		    return uplo == Triangle::lower ? n_row*(n_row + 1)/2 + n_column
+			: n_row*this->matrix_shape.second - n_row*(n_row - 1)/2 + (n_column - n_row);
+		}
+		/**
+		 * @brief Overloading of operator() for the Packed_triangular class
+		 *
+		 * Return a reference to the element in row n_row and column n_column.
+		 *
+		 * @param n_row Row of the desired element.
+		 * @param n_column Column of the desired element.
+		 * @returns A reference to the desired element in the matrix.
+		 *
+		 * @throws IndexOutOfBoundsException if one of the given indices is not valid or the element is not stored.
+		 */
+		scalar_type& operator()(const size_t n_row, const size_t n_column){
+
+		    if (n_row < this->matrix_shape.first && n_column < this->matrix_shape.second && stored(n_row, n_column))
+			return this->elements[offset(n_row, n_column)];
+		    throw IndexOutOfBoundsException{};
+		}
+		/**
+		 * @brief Overloading of operator() for the Packed_triangular class
+		 *
+		 * Return a const reference to the element in row n_row and column n_column, which
+		 * is zero outside the triangle.
+		 *
+		 * @param n_row Row of the desired element.
+		 * @param n_column Column of the desired element.
+		 * @returns A const reference to the desired element in the matrix.
+		 *
+		 * @throws IndexOutOfBoundsException if one of the given indices is not valid.
+		 */
+		const scalar_type& operator()(const size_t n_row, const size_t n_column) const {
+
+		    if (n_row < this->matrix_shape.first && n_column < this->matrix_shape.second)
+			return stored(n_row, n_column) ? this->elements[offset(n_row, n_column)] : base::zero();
+		    throw IndexOutOfBoundsException{};
+		}
+		//! Access the element with the given sequential index, counted by rows
+		scalar_type& operator()(const size_t index){
+
+		    if (index <= this->max_index)
+			return (*this)(index / this->matrix_shape.second, index % this->matrix_shape.second);
+		    throw IndexOutOfBoundsException{};
+		}
+		//! Const version of operator()(index)
+		const scalar_type& operator()(const size_t index) const {
+
+		    if (index <= this->max_index)
+			return (*this)(index / this->matrix_shape.second, index % this->matrix_shape.second);
+		    throw IndexOutOfBoundsException{};
+		}
+		/**
+		 * @brief Get the full Matrix represented by this object
+		 *
+		 * @returns A row major Matrix with the same elements
+		 */
+		Matrix<T> unpack() const {
+
+		    Matrix<T> result{this->matrix_shape.first, this->matrix_shape.second};
+		    for (size_t i = 0; i < this->matrix_shape.first; ++i)
+			for (size_t j = 0; j < this->matrix_shape.second; ++j)
+			    result(i, j) = (*this)(i, j);
+		    return result;
+		}
+	};
+
+	/////////////////////
+	// BANDED MATRIX CLASS
+	/////////////////////
+
+	/**
+	 * @class Banded
+	 *
+	 * @brief Matrix storing only a band around its diagonal
+	 *
+	 * A banded matrix with kl sub-diagonals and ku super-diagonals stores, for every row i, the
+	 * kl + ku + 1 elements in columns [i - kl, i + ku] contiguously: the element in row i and column j
+	 * is at offset i*(kl + ku + 1) + j - i + kl. Positions of the band falling outside the matrix are
+	 * stored but never used. Const accesses outside the band return zero, non const ones throw.
+	 */
+	template <typename T>
+	class Banded : public Packed_storage<T>{
+
+	    using base = Packed_storage<T>;
+
+	    //! Number of sub-diagonals
+	    size_t lower_bandwidth;
+	    //! Number of super-diagonals
+	    size_t upper_bandwidth;
+
+	    public:
+
+		using typename base::shape;
+		using typename base::scalar_type;
+
+		/**
+		 * Create a banded matrix with all elements equal to zero
+		 *
+		 * @param n_rows Number of rows in the matrix
+		 * @param n_columns Number of columns in the matrix
+		 * @param kl Number of sub-diagonals
+		 * @param ku Number of super-diagonals
+		 */
+		Banded (const size_t n_rows, const size_t n_columns, const size_t kl, const size_t ku) :
+		    base{shape{n_rows, n_columns}, n_rows*(kl + ku + 1)}, lower_bandwidth{kl}, upper_bandwidth{ku}
+		{}
+		/**
+		 * Create a banded matrix from the band of a Matrix
+		 *
+		 * @param other The matrix to read
+		 * @param kl Number of sub-diagonals
+		 * @param ku Number of super-diagonals
+		 */
+		template <typename L>
+		Banded (const Matrix<T, L>& other, const size_t kl, const size_t ku) :
+		    Banded(other.get_shape().first, other.get_shape().second, kl, ku)
+		{
+		    for (size_t i = 0; i < this->matrix_shape.first; ++i)
+			for (size_t j = first_column(i); j < end_column(i); ++j)
+			    this->elements[offset(i, j)] = other(i, j);
+		}
+
+		//! Get the number of sub-diagonals
+		size_t get_lower_bandwidth() const noexcept { return lower_bandwidth;}
+		//! Get the number of super-diagonals
+		size_t get_upper_bandwidth() const noexcept { return upper_bandwidth;}
+		//! Get the number of elements stored for each row
+		size_t get_band_width() const noexcept { return lower_bandwidth + upper_bandwidth + 1;}
+		//! First column of the band in row n_row
+		size_t first_column (const size_t n_row) const noexcept { return n_row > lower_bandwidth ? n_row - lower_bandwidth : 0;}
+		//! One past the last column of the band in row n_row
+		size_t end_column (const size_t n_row) const noexcept { return std::min(n_row + upper_bandwidth + 1, this->matrix_shape.second);}
+		//! Check whether the element in row n_row and column n_column is stored
+		bool stored (const size_t n_row, const size_t n_column) const noexcept {
+
+		    return n_column + lower_bandwidth >= n_row && n_column <= n_row + upper_bandwidth;
+		}
+		/**
+		 * @brief Position in storage of a stored element
+		 *
+		 * @param n_row Row of the element
+		 * @param n_column Column of the element
+		 * @returns The offset of the element in the storage
+		 */
+		size_t offset (const size_t n_row, const size_t n_column) const noexcept {
+
+		    return n_row*get_band_width() + n_column + lower_bandwidth - n_row;
+		}
+		/**
+		 * @brief Overloading of operator() for the Banded class
+		 *
+		 * Return a reference to the element in row n_row and column n_column.
+		 *
+		 * @param n_row Row of the desired element.
+		 * @param n_column Column of the desired element.
+		 * @returns A reference to the desired element in the matrix.
+		 *
+		 * @throws IndexOutOfBoundsException if one of the given indices is not valid or the element is not stored.
+		 */
+		scalar_type& operator()(const size_t n_row, const size_t n_column){
+
+		    if (n_row < this->matrix_shape.first && n_column < this->matrix_shape.second && stored(n_row, n_column))
+			return this->elements[offset(n_row, n_column)];
+		    throw IndexOutOfBoundsException{};
+		}
+		/**
+		 * @brief Overloading of operator() for the Banded class
+		 *
+		 * Return a const reference to the element in row n_row and column n_column, which
+		 * is zero outside the band.
+		 *
+		 * @param n_row Row of the desired element.
+		 * @param n_column Column of the desired element.
+		 * @returns A const reference to the desired element in the matrix.
+		 *
+		 * @throws IndexOutOfBoundsException if one of the given indices is not valid.
+		 */
+		const scalar_type& operator()(const size_t n_row, const size_t n_column) const {
+
+		    if (n_row < this->matrix_shape.first && n_column < this->matrix_shape.second)
+			return stored(n_row, n_column) ? this->elements[offset(n_row, n_column)] : base::zero();
+		    throw IndexOutOfBoundsException{};
+		}
+		//! Access the element with the given sequential index, counted by rows
+		scalar_type& operator()(const size_t index){
+
+		    if (index <= this->max_index)
+			return (*this)(index / this->matrix_shape.second, index % this->matrix_shape.second);
+		    throw IndexOutOfBoundsException{};
+		}
+		//! Const version of operator()(index)
+		const scalar_type& operator()(const size_t index) const {
+
+		    if (index <= this->max_index)
+			return (*this)(index / this->matrix_shape.second, index % this->matrix_shape.second);
+		    throw IndexOutOfBoundsException{};
+		}
+		/**
+		 * @brief Get the full Matrix represented by this object
+		 *
+		 * @returns A row major Matrix with the same elements
+		 */
+		Matrix<T> unpack() const {
+
+		    Matrix<T> result{this->matrix_shape.first, this->matrix_shape.second};
+		    for (size_t i = 0; i < this->matrix_shape.first; ++i)
+			for (size_t j = 0; j < this->matrix_shape.second; ++j)
+			    result(i, j) = (*this)(i, j);
+		    return result;
+		}
+	};
+
+	/////////////////////
+	// PACKED KERNEL HELPERS
+	/////////////////////
+	namespace detail{
+
+	    //! Minimum number of columns a thread updates in level 3 kernels
+	    constexpr size_t column_grain = 64;
+
+	    /**
+	     * target(i, [begin, end)) += alpha*source(k, [begin, end)), rows being contiguous for row major matrices
+	     */
+	    template <typename T, typename L1, typename L2>
+	    void row_axpy (const T alpha, const Matrix<T, L1>& source, const size_t k, Matrix<T, L2>& target, const size_t i,
+		    const size_t begin, const size_t end) noexcept {
+
+		const T* x = source.data();
+		T* y = target.data();
+		for (size_t j = begin; j < end; ++j)
+		    y[target.get_layout().offset(i, j)] += alpha*x[source.get_layout().offset(k, j)];
+	    }
+	    /**
+	     * target(i, [begin, end)) *= alpha, alpha equal to zero clears the row
+	     */
+	    template <typename T, typename L>
+	    void row_scal (const T alpha, Matrix<T, L>& target, const size_t i, const size_t begin, const size_t end) noexcept {
+
+		T* y = target.data();
+		for (size_t j = begin; j < end; ++j){
+
+		    T& value = y[target.get_layout().offset(i, j)];
+		    value = alpha == T{} ? T{} : alpha*value;
+		}
+	    }
+	    /**
+	     * Dot product of rows i and k of a
+	     */
+	    template <typename T, typename L>
+	    T row_dot (const Matrix<T, L>& a, const size_t i, const size_t k) noexcept {
+
+		const size_t n = a.get_shape().second;
+		if constexpr (std::is_same<typename L::traversal, row_traversal_tag>::value){
+
+		    return dot_kernel(a.data() + a.get_layout().offset(i, 0), size_t{1}, a.data() + a.get_layout().offset(k, 0), size_t{1}, n);
+		}
+		else{
+
+		    T sum{};
+		    for (size_t j = 0; j < n; ++j)
+			sum += a.data()[a.get_layout().offset(i, j)]*a.data()[a.get_layout().offset(k, j)];
+		    return sum;
+		}
+	    }
+	}
+
+	/////////////////////
+	// SYMMETRIC KERNELS
+	/////////////////////
+	    /**
+	     * @brief Compute c = alpha*a*b + beta*c for a symmetric matrix a
+	     *
+	     * Each stored element of a is read once for every group of columns of c and contributes
+	     * to the two rows of c it belongs to. Threads work on different groups of columns.
+	     *
+	     * @param alpha Scalar multiplying the product
+	     * @param a Symmetric matrix of order n
+	     * @param b Matrix with n rows
+	     * @param beta Scalar multiplying c
+	     * @param c Matrix with the shape of b, updated in place
+	     *
+	     * @throws ShapeMismatchException if the shapes of b and c do not match a.
+	     */
+	    template <typename T, typename L1, typename L2>
+	    void symm (const typename Packed_symmetric<T>::scalar_type alpha, const Packed_symmetric<T>& a, const Matrix<T, L1>& b,
+		    const typename Packed_symmetric<T>::scalar_type beta, Matrix<T, L2>& c){
+
+		const size_t n = a.get_shape().first;
+		const size_t m = b.get_shape().second;
+		if (b.get_shape().first != n || c.get_shape() != b.get_shape())
+		    throw ShapeMismatchException{};
+
+		parallel_for(0, m, detail::column_grain, [&](size_t, size_t begin, size_t end){
+		    for (size_t i = 0; i < n; ++i)
+			detail::row_scal(beta, c, i, begin, end);
+
+		    const T* stored = a.data();
+		    for (size_t i = 0; i < n; ++i)
+			for (size_t k = 0; k <= i; ++k, ++stored){
+
+			    detail::row_axpy(alpha*(*stored), b, k, c, i, begin, end);
+			    if (k != i)
+				detail::row_axpy(alpha*(*stored), b, i, c, k, begin, end);
+			}
+		});
+	    }
+	    /**
+	     * @brief Compute c = alpha*a*a^T + beta*c for a symmetric matrix c
+	     *
+	     * Only the stored triangle of c is computed, each element being the dot product
+	     * of two rows of a. Threads work on different pairs of rows of c, a short one and a long one.
+	     *
+	     * @param alpha Scalar multiplying the product
+	     * @param a Matrix with n rows
+	     * @param beta Scalar multiplying c
+	     * @param c Symmetric matrix of order n, updated in place
+	     *
+	     * @throws ShapeMismatchException if c and a have a different number of rows.
+	     */
+	    template <typename T, typename L>
+	    void syrk (const typename Matrix<T, L>::scalar_type alpha, const Matrix<T, L>& a, const typename Matrix<T, L>::scalar_type beta,
+		    Packed_symmetric<T>& c){
+
+		const size_t n = c.get_shape().first;
+		if (a.get_shape().first != n)
+		    throw ShapeMismatchException{};
+
+		T* stored = c.data();
+		auto update_row = [&](size_t i){
+		    for (size_t k = 0; k <= i; ++k){
+
+			T& value = stored[Packed_symmetric<T>::offset(i, k)];
+			value = (beta == T{} ? T{} : beta*value) + alpha*detail::row_dot(a, i, k);
+		    }
+		};
+		//row i costs i + 1 dot products: pairing it with row n - 1 - i gives chunks of equal cost
+		parallel_for(0, (n + 1) / 2, 1, [&](size_t, size_t begin, size_t end){
+		    for (size_t i = begin; i < end; ++i){
+
+			update_row(i);
+			if (n - 1 - i != i)
+			    update_row(n - 1 - i);
+		    }
+		});
+	    }
+
+	/////////////////////
+	// TRIANGULAR KERNELS
+	/////////////////////
+	    /**
+	     * @brief Compute b = alpha*a*b for a triangular matrix a
+	     *
+	     * Rows of b are overwritten in the order that leaves the rows still needed untouched:
+	     * from the last for lower triangular matrices and from the first for upper ones. Threads
+	     * work on different groups of columns.
+	     *
+	     * @param diag Whether to assume ones on the diagonal of a
+	     * @param alpha Scalar multiplying the product
+	     * @param a Triangular matrix of order n
+	     * @param b Matrix with n rows, updated in place
+	     *
+	     * @throws ShapeMismatchException if b and a have a different number of rows.
+	     */
+	    template <typename T, typename L>
+	    void trmm (const Diagonal diag, const typename Packed_triangular<T>::scalar_type alpha, const Packed_triangular<T>& a, Matrix<T, L>& b){
+
+		const size_t n = a.get_shape().first;
+		if (b.get_shape().first != n)
+		    throw ShapeMismatchException{};
+		const bool lower = a.get_triangle() == Triangle::lower;
+
+		parallel_for(0, b.get_shape().second, detail::column_grain, [&](size_t, size_t begin, size_t end){
+		    for (size_t step = 0; step < n; ++step){
+
+			const size_t i = lower ? n - 1 - step : step;
+			const T diagonal = diag == Diagonal::unit ? T{1} : a.data()[a.offset(i, i)];
+			detail::row_scal(alpha*diagonal, b, i, begin, end);
+
+			const size_t k_begin = lower ? 0 : i + 1;
+			const size_t k_end = lower ? i : n;
+			for (size_t k = k_begin; k < k_end; ++k)
+			    detail::row_axpy(alpha*a.data()[a.offset(i, k)], b, k, b, i, begin, end);
+		    }
+		});
+	    }
+	    /**
+	     * @brief Solve a*x = alpha*b for a triangular matrix a
+	     *
+	     * On exit b holds x. Rows are solved by forward substitution for lower triangular
+	     * matrices and by backward substitution for upper ones; threads work on different
+	     * groups of columns.
+	     *
+	     * @param diag Whether to assume ones on the diagonal of a
+	     * @param alpha Scalar multiplying b
+	     * @param a Triangular matrix of order n
+	     * @param b Matrix with n rows, updated in place
+	     *
+	     * @throws ShapeMismatchException if b and a have a different number of rows.
+	     * @throws SingularMatrixException if a has a zero on the diagonal.
+	     */
+	    template <typename T, typename L>
+	    void trsm (const Diagonal diag, const typename Packed_triangular<T>::scalar_type alpha, const Packed_triangular<T>& a, Matrix<T, L>& b){
+
+		const size_t n = a.get_shape().first;
+		if (b.get_shape().first != n)
+		    throw ShapeMismatchException{};
+		if (diag == Diagonal::non_unit)
+		    for (size_t i = 0; i < n; ++i)
+			if (a.data()[a.offset(i, i)] == T{})
+			    throw SingularMatrixException{};
+		const bool lower = a.get_triangle() == Triangle::lower;
+
+		parallel_for(0, b.get_shape().second, detail::column_grain, [&](size_t, size_t begin, size_t end){
+		    for (size_t step = 0; step < n; ++step){
+
+			const size_t i = lower ? step : n - 1 - step;
+			detail::row_scal(alpha, b, i, begin, end);
+
+			const size_t k_begin = lower ? 0 : i + 1;
+			const size_t k_end = lower ? i : n;
+			for (size_t k = k_begin; k < k_end; ++k)
+			    detail::row_axpy(-a.data()[a.offset(i, k)], b, k, b, i, begin, end);
+			if (diag == Diagonal::non_unit)
+			    detail::row_scal(T{1}/a.data()[a.offset(i, i)], b, i, begin, end);
+		    }
+		});
+	    }
+
+	/////////////////////
+	// BANDED KERNELS
+	/////////////////////
+	    /**
+	     * @brief Compute y = alpha*op(a)*x + beta*y for a banded matrix a
+	     *
+	     * Without transposition each element of y is the dot product of the contiguous band of
+	     * a row with x, and threads work on different rows. With transposition threads own
+	     * segments of y and accumulate the rows whose band overlaps them.
+	     *
+	     * @param trans Whether to use a or its transpose
+	     * @param alpha Scalar multiplying the product
+	     * @param a The banded matrix
+	     * @param x A Vector or a Vector_view with as many elements as the columns of op(a)
+	     * @param beta Scalar multiplying y
+	     * @param y A Vector or a Vector_view with as many elements as the rows of op(a), updated in place
+	     *
+	     * @throws ShapeMismatchException if the sizes of x and y do not match the shape of op(a).
+	     */
+	    template <typename T, typename V1, typename V2>
+	    void gbmv (const Transpose trans, const typename Banded<T>::scalar_type alpha, const Banded<T>& a, const V1& x,
+		    const typename Banded<T>::scalar_type beta, V2&& y){
+
+		const bool transposed = trans == Transpose::transpose;
+		const size_t n_rows = a.get_shape().first;
+		detail::check_size(x, transposed ? n_rows : a.get_shape().second);
+		detail::check_size(y, transposed ? a.get_shape().second : n_rows);
+
+		const T* a_data = a.data();
+		const T* x_data = x.data();
+		T* y_data = y.data();
+		const size_t x_stride = x.get_stride(), y_stride = y.get_stride();
+		const size_t width = a.get_band_width();
+
+		if (!transposed){
+
+		    parallel_for(0, n_rows, detail::blas_grain / width + 1, [&](size_t, size_t begin, size_t end){
+			for (size_t i = begin; i < end; ++i){
+
+			    const size_t first = a.first_column(i), last = a.end_column(i);
+			    const T sum = first < last ? detail::dot_kernel(a_data + a.offset(i, first), size_t{1}, x_data + first*x_stride, x_stride, last - first) : T{};
+			    T& target = y_data[i*y_stride];
+			    target = (beta == T{} ? T{} : beta*target) + alpha*sum;
+			}
+		    });
+		}
+		else{
+
+		    const size_t kl = a.get_lower_bandwidth(), ku = a.get_upper_bandwidth();
+		    parallel_for(0, a.get_shape().second, detail::blas_grain / width + 64, [&](size_t, size_t begin, size_t end){
+			detail::scal_kernel(beta, y_data + begin*y_stride, y_stride, end - begin);
+			//rows whose band intersects columns [begin, end)
+			const size_t row_begin = begin > ku ? begin - ku : 0;
+			const size_t row_end = std::min(end + kl, n_rows);
+			for (size_t i = row_begin; i < row_end; ++i){
+
+			    const size_t first = std::max(a.first_column(i), begin), last = std::min(a.end_column(i), end);
+			    if (first < last)
+				detail::axpy_kernel(alpha*x_data[i*x_stride], a_data + a.offset(i, first), size_t{1}, y_data + first*y_stride, y_stride, last - first);
+			}
+		    });
+		}
+	    }
+	    /**
+	     * @brief Solve the banded system a*x = b
+	     *
+	     * Gaussian elimination with partial pivoting is performed on a copy of the band, widened
+	     * by kl super-diagonals to hold the fill-in caused by row exchanges, so only O(n*kl*(kl + ku))
+	     * operations are needed. On entry x holds b, on exit the solution.
+	     *
+	     * @param a Square banded matrix
+	     * @param x A Vector or a Vector_view with as many elements as the rows of a, updated in place
+	     *
+	     * @throws ShapeMismatchException if a is not square or the size of x does not match it.
+	     * @throws SingularMatrixException if a is singular.
+	     */
+	    template <typename T, typename V>
+	    void gbsv (const Banded<T>& a, V&& x){
+
+		const size_t n = a.get_shape().first;
+		if (a.get_shape().second != n)
+		    throw ShapeMismatchException{};
+		detail::check_size(x, n);
+
+		const size_t kl = a.get_lower_bandwidth(), ku = a.get_upper_bandwidth();
+		//row i of the work band holds columns [i - kl, i + kl + ku]
+		const size_t width = 2*kl + ku + 1;
+		std::vector<T> work(n*width, T{});
+		auto at = [&](size_t i, size_t j) -> T& { return work[i*width + j + kl - i];};
+		for (size_t i = 0; i < n; ++i)
+		    for (size_t j = a.first_column(i); j < a.end_column(i); ++j)
+			at(i, j) = a.data()[a.offset(i, j)];
+
+		T* b = x.data();
+		const size_t stride = x.get_stride();
+		for (size_t c = 0; c < n; ++c){
+
+		    const size_t row_end = std::min(c + kl + 1, n);
+		    const size_t column_end = std::min(c + kl + ku + 1, n);
+
+		    size_t pivot = c;
+		    for (size_t r = c + 1; r < row_end; ++r)
+			if (std::abs(at(r, c)) > std::abs(at(pivot, c)))
+			    pivot = r;
+		    if (at(pivot, c) == T{})
+			throw SingularMatrixException{};
+		    if (pivot != c){
+
+			for (size_t j = c; j < column_end; ++j)
+			    std::swap(at(c, j), at(pivot, j));
+			std::swap(b[c*stride], b[pivot*stride]);
+		    }
+
+		    for (size_t r = c + 1; r < row_end; ++r){
+
+			const T factor = at(r, c)/at(c, c);
+			if (factor == T{})
+			    continue;
+			detail::axpy_kernel(-factor, &at(c, c), size_t{1}, &at(r, c), size_t{1}, column_end - c);
+			b[r*stride] -= factor*b[c*stride];
+		    }
+		}
+
+		for (size_t step = 0; step < n; ++step){
+
+		    const size_t i = n - 1 - step;
+		    const size_t column_end = std::min(i + kl + ku + 1, n);
+		    const T sum = detail::dot_kernel(&at(i, i) + 1, size_t{1}, b + (i + 1)*stride, stride, column_end - i - 1);
+		    b[i*stride] = (b[i*stride] - sum)/at(i, i);
+		}
+	    }
+    }
+}
+
+#endif
@@ -0,0 +1,201 @@
+//: marsh/Parallel.hpp
+/**
+ * @file marsh/Parallel.hpp
+ */
+
+#ifndef MARSH_PARALLEL_HPP
+#define MARSH_PARALLEL_HPP
+
+/*
+ * Include headers
+ */
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+#include "Thread_pool.hpp"
+
+namespace leaqx8664{
+
+    namespace marsh{
+
+	/////////////////////
+	// PARALLEL WORKERS
+	/////////////////////
+	    namespace detail{
+
+		/**
+		 * Pool shared by all the calls to parallel_for, created on first use and never destroyed
+		 * so that kernels running during static destruction still find it
+		 */
+		inline std::atomic<Thread_pool*>& parallel_pool_pointer(){
+
+		    static std::atomic<Thread_pool*> pool{nullptr};
+		    return pool;
+		}
+		/**
+		 * Forget the pool of the parent in a forked child, whose workers were not copied by fork.
+		 * The child creates its own pool on its first parallel_for.
+		 */
+		inline void reset_parallel_pool_after_fork() noexcept {
+
+		    parallel_pool_pointer().store(nullptr);
+		}
+		/**
+		 * Progress of a parallel_for shared by the caller and the jobs it submitted
+		 */
+		struct Parallel_for_state{
+
+		    //! Next chunk to be claimed
+		    std::atomic<size_t> next_chunk{0};
+		    //! Number of completed chunks
+		    size_t completed = 0;
+		    //! First exception thrown by a chunk
+		    std::exception_ptr error;
+		    //! Mutex protecting completed and error
+		    std::mutex state_mutex;
+		    //! Signalled when the last chunk completes
+		    std::condition_variable all_completed;
+		};
+	    }
+
+	    /**
+	     * @brief Get the workers used by parallel_for
+	     *
+	     * The pool has one worker less than the hardware threads, the calling thread being the last one.
+	     *
+	     * @returns The pool shared by all parallel kernels
+	     */
+	    inline Thread_pool& parallel_pool(){
+
+		auto& pointer = detail::parallel_pool_pointer();
+		Thread_pool* pool = pointer.load(std::memory_order_acquire);
+		if (!pool){
+
+		    const size_t hardware_threads = std::thread::hardware_concurrency();
+		    Thread_pool* created = new Thread_pool{hardware_threads > 1 ? hardware_threads - 1 : 1};
+		    if (pointer.compare_exchange_strong(pool, created, std::memory_order_acq_rel))
+			pool = created;
+		    else
+			delete created;
+		}
+		return *pool;
+	    }
+
+	/////////////////////
+	// PARALLEL FOR
+	/////////////////////
+	    /**
+	     * @brief Number of chunks parallel_for splits a range in
+	     *
+	     * The range is split in at most get_num_threads() chunks, each containing at least
+	     * grain elements. The partition only depends on the range, the grain and the number
+	     * of threads.
+	     *
+	     * @param begin First index of the range
+	     * @param end One past the last index of the range
+	     * @param grain Minimum number of indices in a chunk
+	     * @returns The number of chunks
+	     */
+	    inline size_t parallel_chunks(const size_t begin, const size_t end, const size_t grain) noexcept {
+
+		if (end <= begin)
+		    return 0;
+		const size_t max_chunks = (end - begin) / (grain ? grain : 1);
+		const size_t n_threads = get_num_threads();
+		return max_chunks == 0 ? 1 : (max_chunks < n_threads ? max_chunks : n_threads);
+	    }
+	    /**
+	     * @brief Run a function on a given number of chunks of a range using multiple threads
+	     *
+	     * The range [begin, end) is split in n_chunks contiguous chunks and body(chunk, chunk_begin, chunk_end)
+	     * is called once for each of them. Kernels keeping per chunk results size their buffers with the same
+	     * n_chunks, so that a concurrent set_num_threads can not make the two disagree. Chunks are claimed in
+	     * order by the calling thread and by the workers of parallel_pool(), so the caller never waits for a
+	     * chunk that has not started and nested calls can not deadlock. The call returns when all chunks have
+	     * been processed; if some of them threw, the first exception is then rethrown.
+	     *
+	     * @param begin First index of the range
+	     * @param end One past the last index of the range
+	     * @param n_chunks Number of chunks, usually obtained from parallel_chunks
+	     * @param body Function called on each chunk
+	     */
+	    template <typename F>
+	    void parallel_for_chunks(const size_t begin, const size_t end, const size_t n_chunks, F&& body){
+
+		if (end <= begin || n_chunks == 0)
+		    return;
+		if (n_chunks == 1){
+
+		    body(size_t{0}, begin, end);
+		    return;
+		}
+
+		const size_t length = end - begin;
+		auto chunk_begin = [=](size_t chunk){ return begin + length / n_chunks * chunk + (chunk < length % n_chunks ? chunk : length % n_chunks);};
+
+		//jobs may start after the call returned: they only touch body once they claim a chunk
+		auto state = std::make_shared<detail::Parallel_for_state>();
+		auto run = [state, &body, chunk_begin, n_chunks](){
+		    for (size_t chunk = state->next_chunk++; chunk < n_chunks; chunk = state->next_chunk++){
+
+			std::exception_ptr error;
+			try{
+			    body(chunk, chunk_begin(chunk), chunk_begin(chunk + 1));
+			}
+			catch (...){
+			    error = std::current_exception();
+			}
+			std::lock_guard<std::mutex> lock{state->state_mutex};
+			if (error && !state->error)
+			    state->error = error;
+			if (++state->completed == n_chunks)
+			    state->all_completed.notify_all();
+		    }
+		};
+		//the caller processes the chunks left and waits for the others, even if submitting failed
+		auto finish = [&state, &run, n_chunks](){
+		    run();
+		    std::unique_lock<std::mutex> lock{state->state_mutex};
+		    state->all_completed.wait(lock, [&state, n_chunks](){ return state->completed == n_chunks;});
+		};
+
+		Thread_pool& pool = parallel_pool();
+		const size_t n_jobs = n_chunks - 1 < pool.get_size() ? n_chunks - 1 : pool.get_size();
+		try{
+		    for (size_t job = 0; job < n_jobs; ++job)
+			pool.submit(run);
+		}
+		catch (...){
+		    finish();
+		    throw;
+		}
+		finish();
+		if (state->error)
+		    std::rethrow_exception(state->error);
+	    }
+	    /**
+	     * @brief Run a function on the chunks of a range using multiple threads
+	     *
+	     * The range [begin, end) is split in parallel_chunks(begin, end, grain) contiguous chunks,
+	     * processed as by parallel_for_chunks.
+	     *
+	     * @param begin First index of the range
+	     * @param end One past the last index of the range
+	     * @param grain Minimum number of indices in a chunk
+	     * @param body Function called on each chunk
+	     */
+	    template <typename F>
+	    void parallel_for(const size_t begin, const size_t end, const size_t grain, F&& body){
+
+		parallel_for_chunks(begin, end, parallel_chunks(begin, end, grain), std::forward<F>(body));
+	    }
+    }
+}
+
+#endif
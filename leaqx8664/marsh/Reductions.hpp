@@ -0,0 +1,622 @@
+//: marsh/Reductions.hpp
+/**
+ * @file marsh/Reductions.hpp
+ */
+
+#ifndef MARSH_REDUCTIONS_HPP
+#define MARSH_REDUCTIONS_HPP
+
+/*
+ * Include headers
+ */
+#include <cmath>
+#include <vector>
+#include <utility>
+#include <type_traits>
+
+#include "../leaq_exceptions.hpp"
+#include "Layouts.hpp"
+#include "Parallel.hpp"
+#include "Vector.hpp"
+#include "Matrix.hpp"
+#include "Blas.hpp"
+
+namespace leaqx8664{
+
+    namespace marsh{
+
+	/////////////////////
+	// REDUCTION HELPERS
+	/////////////////////
+	namespace detail{
+
+	    //! Minimum number of elements a thread reduces
+	    constexpr size_t reduction_grain = size_t{1} << 14;
+	    //! Number of elements summed directly by pairwise_sum
+	    constexpr size_t pairwise_block = 128;
+
+	    //! Transformation leaving elements unchanged
+	    struct Identity{
+
+		template <typename T>
+		T operator()(const T& x) const noexcept { return x;}
+	    };
+	    //! Transformation taking the absolute value of elements
+	    struct Absolute{
+
+		template <typename T>
+		T operator()(const T& x) const noexcept { return x < T{} ? -x : x;}
+	    };
+
+	    /**
+	     * Pairwise sum of f(x[i]) for n contiguous elements. Blocks of pairwise_block elements are
+	     * summed with eight independent accumulators, which the compiler can map to SIMD lanes, and
+	     * blocks are added pairwise, so the rounding error grows with log(n) instead of n.
+	     */
+	    template <typename T, typename F>
+	    T pairwise_sum (const T* x, const size_t n, F f) noexcept {
+
+		if (n <= pairwise_block){
+
+		    T s[8] = {};
+		    size_t i = 0;
+		    for (; i + 8 <= n; i += 8)
+			for (size_t k = 0; k < 8; ++k)
+			    s[k] += f(x[i + k]);
+		    for (; i < n; ++i)
+			s[0] += f(x[i]);
+		    return ((s[0] + s[1]) + (s[2] + s[3])) + ((s[4] + s[5]) + (s[6] + s[7]));
+		}
+		const size_t half = (n / 2 + 7) / 8 * 8;
+		return pairwise_sum(x, half, f) + pairwise_sum(x + half, n - half, f);
+	    }
+
+	    /**
+	     * @class Compensated_sum
+	     *
+	     * Running sum of values, compensated with the Kahan-Babuska (Neumaier) algorithm
+	     * for floating point types.
+	     */
+	    template <typename T>
+	    class Compensated_sum{
+
+		//! Running sum
+		T sum{};
+		//! Accumulated rounding error
+		T compensation{};
+
+		public:
+
+		    //! Add value to the sum
+		    void add (const T value) noexcept {
+
+			if constexpr (std::is_floating_point<T>::value){
+
+			    const T t = sum + value;
+			    if ((sum < T{} ? -sum : sum) >= (value < T{} ? -value : value))
+				compensation += (sum - t) + value;
+			    else
+				compensation += (value - t) + sum;
+			    sum = t;
+			}
+			else
+			    sum += value;
+		    }
+		    //! Get the compensated sum
+		    T result () const noexcept { return sum + compensation;}
+	    };
+
+	    /**
+	     * @class Extremum
+	     *
+	     * Smallest element according to a comparison, together with its position. Ties are
+	     * resolved in favour of the first position in row order, so results do not depend on
+	     * the layout or on the number of threads.
+	     */
+	    template <typename T>
+	    struct Extremum{
+
+		//! Value of the element
+		T value{};
+		//! Row of the element
+		size_t row = 0;
+		//! Column of the element
+		size_t column = 0;
+		//! False until an element has been considered
+		bool valid = false;
+
+		//! Replace the extremum with the given element if it comes first
+		template <typename Compare>
+		void update (const T& candidate, const size_t candidate_row, const size_t candidate_column, Compare before) noexcept {
+
+		    if (!valid || before(candidate, value)
+			    || (!before(value, candidate) && std::make_pair(candidate_row, candidate_column) < std::make_pair(row, column))){
+
+			value = candidate;
+			row = candidate_row;
+			column = candidate_column;
+			valid = true;
+		    }
+		}
+	    };
+
+	    /**
+	     * @class Matrix_lines
+	     *
+	     * Presents a matrix as a sequence of contiguous lines: rows for row major and recursive
+	     * layouts, columns for column major layouts. Rows of tiled and Morton matrices are not
+	     * contiguous, so they are gathered into a buffer before being passed to the kernels.
+	     */
+	    template <typename T, typename L>
+	    class Matrix_lines{
+
+		//! The matrix being read
+		const Matrix<T, L>& matrix;
+
+		public:
+
+		    //! True if lines are rows of the matrix, false if they are columns
+		    static constexpr bool by_rows = !std::is_same<typename L::traversal, column_traversal_tag>::value;
+		    //! True if lines can be read in place
+		    static constexpr bool contiguous = !std::is_same<typename L::traversal, recursive_traversal_tag>::value;
+
+		    explicit Matrix_lines (const Matrix<T, L>& target) noexcept : matrix{target} {}
+
+		    //! Number of lines
+		    size_t count () const noexcept { return by_rows ? matrix.get_shape().first : matrix.get_shape().second;}
+		    //! Number of elements in each line
+		    size_t length () const noexcept { return by_rows ? matrix.get_shape().second : matrix.get_shape().first;}
+		    /**
+		     * Pointer to the elements [begin, end) of a line, read in place or gathered in buffer
+		     */
+		    const T* segment (const size_t line, const size_t begin, const size_t end, std::vector<T>& buffer) const {
+
+			if constexpr (contiguous){
+
+			    return matrix.data() + (by_rows ? matrix.get_layout().offset(line, begin) : matrix.get_layout().offset(begin, line));
+			}
+			else{
+
+			    buffer.resize(end - begin);
+			    for (size_t k = begin; k < end; ++k)
+				buffer[k - begin] = matrix.data()[matrix.get_layout().offset(line, k)];
+			    return buffer.data();
+			}
+		    }
+		    //! Row of the element in position k of a line
+		    size_t row (const size_t line, const size_t k) const noexcept { return by_rows ? line : k;}
+		    //! Column of the element in position k of a line
+		    size_t column (const size_t line, const size_t k) const noexcept { return by_rows ? k : line;}
+	    };
+
+	    /**
+	     * Compute result(l) = reduce(pointer to line l, length) for every line, with threads
+	     * working on different lines.
+	     */
+	    template <typename T, typename L, typename R>
+	    Vector<T> reduce_each_line (const Matrix_lines<T, L>& lines, R reduce){
+
+		Vector<T> result{lines.count()};
+		const size_t length = lines.length();
+		parallel_for(0, lines.count(), reduction_grain / (length ? length : 1) + 1, [&](size_t, size_t begin, size_t end){
+		    std::vector<T> buffer;
+		    for (size_t l = begin; l < end; ++l)
+			result(l) = reduce(lines.segment(l, 0, length, buffer), length);
+		});
+		return result;
+	    }
+	    /**
+	     * Compute, for every position k in a line, the fold of the elements in position k of all lines.
+	     * Threads own different segments of positions and stream every line over their segment, so lines
+	     * are always read sequentially. combine(first, line_segment, result_segment, begin, end) is called
+	     * for each line in order, with first set for line 0.
+	     */
+	    template <typename T, typename L, typename C>
+	    Vector<T> reduce_across_lines (const Matrix_lines<T, L>& lines, C combine){
+
+		Vector<T> result{lines.length()};
+		const size_t count = lines.count();
+		parallel_for(0, lines.length(), reduction_grain / (count ? count : 1) + 64, [&](size_t, size_t begin, size_t end){
+		    std::vector<T> buffer;
+		    for (size_t l = 0; l < count; ++l)
+			combine(l == 0, lines.segment(l, begin, end, buffer), result.data() + begin, begin, end);
+		});
+		return result;
+	    }
+	    /**
+	     * Per line compensated sums of f(element), either along or across lines
+	     */
+	    template <typename T, typename L, typename F>
+	    Vector<T> line_sums (const Matrix<T, L>& a, const bool along_lines, F f){
+
+		Matrix_lines<T, L> lines{a};
+		if (along_lines)
+		    return reduce_each_line(lines, [f](const T* x, size_t n){ return pairwise_sum(x, n, f);});
+
+		//Kahan summation for every position, compensations live next to the results
+		std::vector<T> compensation(lines.length(), T{});
+		return reduce_across_lines(lines, [f, &compensation](bool first, const T* x, T* sums, size_t begin, size_t end){
+		    T* c = compensation.data() + begin;
+		    if (first){
+
+			for (size_t k = 0; k < end - begin; ++k)
+			    sums[k] = f(x[k]);
+			return;
+		    }
+		    for (size_t k = 0; k < end - begin; ++k){
+
+			const T y = f(x[k]) - c[k];
+			const T t = sums[k] + y;
+			c[k] = (t - sums[k]) - y;
+			sums[k] = t;
+		    }
+		});
+	    }
+	    /**
+	     * Per line extrema according to before, either along or across lines
+	     */
+	    template <typename T, typename L, typename Compare>
+	    Vector<T> line_extrema (const Matrix<T, L>& a, const bool along_lines, Compare before){
+
+		Matrix_lines<T, L> lines{a};
+		if (along_lines)
+		    return reduce_each_line(lines, [before](const T* x, size_t n){
+			T best = x[0];
+			for (size_t k = 1; k < n; ++k)
+			    best = before(x[k], best) ? x[k] : best;
+			return best;
+		    });
+
+		return reduce_across_lines(lines, [before](bool first, const T* x, T* best, size_t begin, size_t end){
+		    for (size_t k = 0; k < end - begin; ++k)
+			best[k] = (first || before(x[k], best[k])) ? x[k] : best[k];
+		});
+	    }
+	    /**
+	     * Extremum of the whole matrix according to before, with its position
+	     */
+	    template <typename T, typename L, typename Compare>
+	    Extremum<T> extremum (const Matrix<T, L>& a, Compare before){
+
+		Matrix_lines<T, L> lines{a};
+		const size_t length = lines.length();
+		const size_t grain = reduction_grain / (length ? length : 1) + 1;
+		const size_t n_chunks = parallel_chunks(0, lines.count(), grain);
+		std::vector<Extremum<T>> partial(n_chunks);
+		parallel_for_chunks(0, lines.count(), n_chunks, [&](size_t chunk, size_t begin, size_t end){
+		    std::vector<T> buffer;
+		    for (size_t l = begin; l < end; ++l){
+
+			const T* x = lines.segment(l, 0, length, buffer);
+			//first extremum of the line, then compare with the current one
+			size_t best = 0;
+			for (size_t k = 1; k < length; ++k)
+			    if (before(x[k], x[best]))
+				best = k;
+			if (length)
+			    partial[chunk].update(x[best], lines.row(l, best), lines.column(l, best), before);
+		    }
+		});
+
+		Extremum<T> result;
+		for (const auto& candidate : partial)
+		    if (candidate.valid)
+			result.update(candidate.value, candidate.row, candidate.column, before);
+		return result;
+	    }
+	    //! Comparison selecting minima
+	    struct Less{
+
+		template <typename T>
+		bool operator()(const T& x, const T& y) const noexcept { return x < y;}
+	    };
+	    //! Comparison selecting maxima
+	    struct Greater{
+
+		template <typename T>
+		bool operator()(const T& x, const T& y) const noexcept { return y < x;}
+	    };
+	}
+
+	/////////////////////
+	// WHOLE MATRIX REDUCTIONS
+	/////////////////////
+	    /**
+	     * @brief Sum of the elements of a matrix
+	     *
+	     * Each contiguous line is summed pairwise and line sums are accumulated with
+	     * compensated summation. Partial results of the threads are added in a fixed
+	     * order, so the result is reproducible for a fixed number of threads.
+	     *
+	     * @param a The matrix
+	     * @returns The sum of the elements of a
+	     */
+	    template <typename T, typename L>
+	    T sum (const Matrix<T, L>& a){
+
+		detail::Matrix_lines<T, L> lines{a};
+		const size_t length = lines.length();
+		const size_t grain = detail::reduction_grain / (length ? length : 1) + 1;
+		const size_t n_chunks = parallel_chunks(0, lines.count(), grain);
+		std::vector<detail::Compensated_sum<T>> partial(n_chunks);
+		parallel_for_chunks(0, lines.count(), n_chunks, [&](size_t chunk, size_t begin, size_t end){
+		    std::vector<T> buffer;
+		    for (size_t l = begin; l < end; ++l)
+			partial[chunk].add(detail::pairwise_sum(lines.segment(l, 0, length, buffer), length, detail::Identity{}));
+		});
+
+		detail::Compensated_sum<T> result;
+		for (const auto& value : partial)
+		    result.add(value.result());
+		return result.result();
+	    }
+	    /**
+	     * @brief Mean of the elements of a matrix
+	     *
+	     * @param a The matrix
+	     * @returns The sum of the elements of a divided by their number
+	     */
+	    template <typename T, typename L>
+	    T mean (const Matrix<T, L>& a){
+
+		return sum(a) / static_cast<T>(a.get_shape().first*a.get_shape().second);
+	    }
+	    /**
+	     * @brief Smallest element of a matrix
+	     *
+	     * @param a The matrix
+	     * @returns The value of the smallest element
+	     */
+	    template <typename T, typename L>
+	    T min (const Matrix<T, L>& a){
+
+		return detail::extremum(a, detail::Less{}).value;
+	    }
+	    /**
+	     * @brief Largest element of a matrix
+	     *
+	     * @param a The matrix
+	     * @returns The value of the largest element
+	     */
+	    template <typename T, typename L>
+	    T max (const Matrix<T, L>& a){
+
+		return detail::extremum(a, detail::Greater{}).value;
+	    }
+	    /**
+	     * @brief Position of the smallest element of a matrix
+	     *
+	     * When several elements are equal to the minimum, the first one in row order is returned.
+	     *
+	     * @param a The matrix
+	     * @returns The row and column of the smallest element
+	     */
+	    template <typename T, typename L>
+	    typename Matrix<T, L>::shape argmin (const Matrix<T, L>& a){
+
+		const auto result = detail::extremum(a, detail::Less{});
+		return {result.row, result.column};
+	    }
+	    /**
+	     * @brief Position of the largest element of a matrix
+	     *
+	     * When several elements are equal to the maximum, the first one in row order is returned.
+	     *
+	     * @param a The matrix
+	     * @returns The row and column of the largest element
+	     */
+	    template <typename T, typename L>
+	    typename Matrix<T, L>::shape argmax (const Matrix<T, L>& a){
+
+		const auto result = detail::extremum(a, detail::Greater{});
+		return {result.row, result.column};
+	    }
+
+	/////////////////////
+	// ROW AND COLUMN REDUCTIONS
+	/////////////////////
+	    /**
+	     * @brief Sum of each row of a matrix
+	     *
+	     * Results do not depend on the number of threads.
+	     *
+	     * @param a The matrix
+	     * @returns A vector with as many elements as the rows of a
+	     */
+	    template <typename T, typename L>
+	    Vector<T> row_sums (const Matrix<T, L>& a){
+
+		return detail::line_sums(a, detail::Matrix_lines<T, L>::by_rows, detail::Identity{});
+	    }
+	    /**
+	     * @brief Sum of each column of a matrix
+	     *
+	     * Results do not depend on the number of threads.
+	     *
+	     * @param a The matrix
+	     * @returns A vector with as many elements as the columns of a
+	     */
+	    template <typename T, typename L>
+	    Vector<T> column_sums (const Matrix<T, L>& a){
+
+		return detail::line_sums(a, !detail::Matrix_lines<T, L>::by_rows, detail::Identity{});
+	    }
+	    /**
+	     * @brief Mean of each row of a matrix
+	     *
+	     * @param a The matrix
+	     * @returns A vector with as many elements as the rows of a
+	     */
+	    template <typename T, typename L>
+	    Vector<T> row_means (const Matrix<T, L>& a){
+
+		Vector<T> result = row_sums(a);
+		for (auto& x : result)
+		    x /= static_cast<T>(a.get_shape().second);
+		return result;
+	    }
+	    /**
+	     * @brief Mean of each column of a matrix
+	     *
+	     * @param a The matrix
+	     * @returns A vector with as many elements as the columns of a
+	     */
+	    template <typename T, typename L>
+	    Vector<T> column_means (const Matrix<T, L>& a){
+
+		Vector<T> result = column_sums(a);
+		for (auto& x : result)
+		    x /= static_cast<T>(a.get_shape().first);
+		return result;
+	    }
+	    /**
+	     * @brief Smallest element of each row of a matrix
+	     *
+	     * @param a The matrix
+	     * @returns A vector with as many elements as the rows of a
+	     */
+	    template <typename T, typename L>
+	    Vector<T> row_minima (const Matrix<T, L>& a){
+
+		return detail::line_extrema(a, detail::Matrix_lines<T, L>::by_rows, detail::Less{});
+	    }
+	    /**
+	     * @brief Largest element of each row of a matrix
+	     *
+	     * @param a The matrix
+	     * @returns A vector with as many elements as the rows of a
+	     */
+	    template <typename T, typename L>
+	    Vector<T> row_maxima (const Matrix<T, L>& a){
+
+		return detail::line_extrema(a, detail::Matrix_lines<T, L>::by_rows, detail::Greater{});
+	    }
+	    /**
+	     * @brief Smallest element of each column of a matrix
+	     *
+	     * @param a The matrix
+	     * @returns A vector with as many elements as the columns of a
+	     */
+	    template <typename T, typename L>
+	    Vector<T> column_minima (const Matrix<T, L>& a){
+
+		return detail::line_extrema(a, !detail::Matrix_lines<T, L>::by_rows, detail::Less{});
+	    }
+	    /**
+	     * @brief Largest element of each column of a matrix
+	     *
+	     * @param a The matrix
+	     * @returns A vector with as many elements as the columns of a
+	     */
+	    template <typename T, typename L>
+	    Vector<T> column_maxima (const Matrix<T, L>& a){
+
+		return detail::line_extrema(a, !detail::Matrix_lines<T, L>::by_rows, detail::Greater{});
+	    }
+
+	/////////////////////
+	// MATRIX NORMS
+	/////////////////////
+	    /**
+	     * @brief 1-norm of a matrix
+	     *
+	     * @param a The matrix
+	     * @returns The largest sum of absolute values in a column
+	     */
+	    template <typename T, typename L>
+	    T norm_1 (const Matrix<T, L>& a){
+
+		Vector<T> sums = detail::line_sums(a, !detail::Matrix_lines<T, L>::by_rows, detail::Absolute{});
+		T result{};
+		for (const auto& x : sums)
+		    result = x > result ? x : result;
+		return result;
+	    }
+	    /**
+	     * @brief Infinity norm of a matrix
+	     *
+	     * @param a The matrix
+	     * @returns The largest sum of absolute values in a row
+	     */
+	    template <typename T, typename L>
+	    T norm_inf (const Matrix<T, L>& a){
+
+		Vector<T> sums = detail::line_sums(a, detail::Matrix_lines<T, L>::by_rows, detail::Absolute{});
+		T result{};
+		for (const auto& x : sums)
+		    result = x > result ? x : result;
+		return result;
+	    }
+	    /**
+	     * @brief Frobenius norm of a matrix
+	     *
+	     * The norm is computed from a scaled sum of squares, as nrm2 does, so it does not
+	     * overflow or underflow unless the result does.
+	     *
+	     * @param a The matrix
+	     * @returns The square root of the sum of the squares of the elements
+	     */
+	    template <typename T, typename L>
+	    T norm_frobenius (const Matrix<T, L>& a){
+
+		detail::Matrix_lines<T, L> lines{a};
+		const size_t length = lines.length();
+		const size_t grain = detail::reduction_grain / (length ? length : 1) + 1;
+		const size_t n_chunks = parallel_chunks(0, lines.count(), grain);
+		std::vector<T> scale(n_chunks, T{}), sum_of_squares(n_chunks, T{1});
+		parallel_for_chunks(0, lines.count(), n_chunks, [&](size_t chunk, size_t begin, size_t end){
+		    std::vector<T> buffer;
+		    for (size_t l = begin; l < end; ++l)
+			detail::sum_of_squares_kernel(lines.segment(l, 0, length, buffer), size_t{1}, length, scale[chunk], sum_of_squares[chunk]);
+		});
+
+		T result_scale{}, result_sum{1};
+		for (size_t chunk = 0; chunk < n_chunks; ++chunk)
+		    detail::merge_sum_of_squares(scale[chunk], sum_of_squares[chunk], result_scale, result_sum);
+		return result_scale*std::sqrt(result_sum);
+	    }
+	    /**
+	     * @brief 2-norm of a matrix
+	     *
+	     * The largest singular value of a is estimated by power iteration on a^T*a, using gemv
+	     * for the products, until the relative change of the estimate drops below tolerance.
+	     * Only floating point matrices are supported.
+	     *
+	     * @param a The matrix
+	     * @param tolerance Relative change of the estimate that stops the iteration
+	     * @param max_iterations Maximum number of iterations
+	     * @returns The estimate of the largest singular value of a
+	     */
+	    template <typename T, typename L>
+	    T norm_2 (const Matrix<T, L>& a, const T tolerance = T(1e-12), const size_t max_iterations = 1000){
+
+		static_assert(std::is_floating_point<T>::value, "norm_2 requires a floating point matrix");
+
+		const size_t n = a.get_shape().second;
+		Vector<T> v{n}, w{a.get_shape().first};
+		//start from a vector that is unlikely to be orthogonal to the dominant singular vector
+		for (size_t j = 0; j < n; ++j)
+		    v(j) = T{1} + T(j % 7)/T{8};
+		scal(T{1}/nrm2(v), v);
+
+		T estimate{};
+		for (size_t iteration = 0; iteration < max_iterations; ++iteration){
+
+		    gemv(Transpose::no_transpose, T{1}, a, v, T{}, w);
+		    gemv(Transpose::transpose, T{1}, a, w, T{}, v);
+		    const T norm = nrm2(v);
+		    if (norm == T{})
+			return T{};
+		    scal(T{1}/norm, v);
+
+		    const T previous = estimate;
+		    estimate = std::sqrt(norm);
+		    if (std::abs(estimate - previous) <= tolerance*estimate)
+			break;
+		}
+		return estimate;
+	    }
+    }
+}
+
+#endif
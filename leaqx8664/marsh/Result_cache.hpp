@@ -0,0 +1,358 @@
+//: marsh/Result_cache.hpp
+/**
+ * @file marsh/Result_cache.hpp
+ */
+
+#ifndef MARSH_RESULT_CACHE_HPP
+#define MARSH_RESULT_CACHE_HPP
+
+/*
+ * Include headers
+ */
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <typeindex>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "Hash.hpp"
+#include "Matrix.hpp"
+
+namespace leaqx8664{
+
+    namespace marsh{
+
+	/////////////////////
+	// CACHE KEY HELPERS
+	/////////////////////
+	namespace detail{
+
+	    /**
+	     * Hash of a matrix argument: the content hash mixed with the type, so that matrices
+	     * with the same storage but different layouts or element types differ. The content
+	     * hash is recomputed from the elements, which may have changed through views.
+	     */
+	    template <typename T, typename L>
+	    std::uint64_t argument_hash (const Matrix<T, L>& matrix){
+
+		return hash_combine(std::type_index{typeid(Matrix<T, L>)}.hash_code(), matrix.get_hash());
+	    }
+	    /**
+	     * Hash of a scalar argument
+	     */
+	    template <typename T, typename = typename std::enable_if<std::is_arithmetic<T>::value>::type>
+	    std::uint64_t argument_hash (const T& value){
+
+		Hash_state state{std::type_index{typeid(T)}.hash_code()};
+		hash_value(state, value);
+		return state.digest();
+	    }
+	    /**
+	     * Memory held by a cached matrix
+	     */
+	    template <typename T, typename L>
+	    size_t result_size (const Matrix<T, L>& matrix) noexcept {
+
+		return sizeof(matrix) + matrix.get_layout().storage_size()*sizeof(T);
+	    }
+	    /**
+	     * Memory held by another cached value
+	     */
+	    template <typename R>
+	    size_t result_size (const R& value) noexcept {
+
+		return sizeof(value);
+	    }
+	}
+
+	/////////////////////
+	// RESULT CACHE CLASS
+	/////////////////////
+
+	/**
+	 * @struct Cache_statistics
+	 *
+	 * @brief Counters describing the activity of a Result_cache
+	 */
+	struct Cache_statistics{
+
+	    //! Lookups that found a cached result
+	    size_t hits = 0;
+	    //! Lookups that had to compute the result
+	    size_t misses = 0;
+	    //! Results added to the cache
+	    size_t insertions = 0;
+	    //! Results removed to respect the limits of the cache
+	    size_t evictions = 0;
+	    //! Number of cached results
+	    size_t entries = 0;
+	    //! Bytes held by the cached results
+	    size_t size = 0;
+
+	    //! Fraction of lookups that were hits, 0 when there were no lookups
+	    double hit_rate() const noexcept {
+
+		return hits + misses ? static_cast<double>(hits) / (hits + misses) : 0.0;
+	    }
+	};
+
+	/**
+	 * @class Result_cache
+	 *
+	 * @brief Thread safe memoisation cache for the results of matrix operations
+	 *
+	 * Results are keyed by the name of the operation and the content hashes of its arguments
+	 * (see Matrix::get_hash), so repeating an operation on equal inputs returns the cached
+	 * result even when the inputs are different objects. Keys are 64 bit hashes: distinct inputs
+	 * colliding would return a wrong result, with a probability of about 2^-64 per lookup.
+	 *
+	 * Caching is switched on per operation with enable(); operations that are not enabled are
+	 * computed directly and not counted in the statistics. The cache holds at most a given number
+	 * of bytes and of results, evicting the least recently used results first.
+	 */
+	class Result_cache{
+
+	    /**
+	     * Identifier of a cached result
+	     */
+	    struct Key{
+
+		//! Name of the operation
+		std::string operation;
+		//! Hashes of the arguments
+		std::vector<std::uint64_t> hashes;
+
+		bool operator== (const Key& other) const { return operation == other.operation && hashes == other.hashes;}
+	    };
+	    /**
+	     * Hash of a key for the index
+	     */
+	    struct Key_hash{
+
+		size_t operator() (const Key& key) const noexcept {
+
+		    std::uint64_t hash = std::hash<std::string>{}(key.operation);
+		    for (const auto h : key.hashes)
+			hash = hash_combine(hash, h);
+		    return static_cast<size_t>(hash);
+		}
+	    };
+	    /**
+	     * A cached result
+	     */
+	    struct Entry{
+
+		//! Key of the result
+		Key key;
+		//! The result
+		std::shared_ptr<const void> value;
+		//! Type of the result
+		std::type_index type;
+		//! Bytes held by the result
+		size_t size;
+	    };
+
+	    ////////////////////////////////
+	    // DATA MEMBERS DECLARATIONS
+	    ////////////////////////////////
+		//! Cached results, most recently used first
+		std::list<Entry> entries;
+		//! Position of the results in entries
+		std::unordered_map<Key, std::list<Entry>::iterator, Key_hash> index;
+		//! Operations whose results are cached
+		std::unordered_set<std::string> enabled_operations;
+		//! Maximum number of bytes held by the results
+		size_t capacity;
+		//! Maximum number of results
+		size_t max_entries;
+		//! Activity counters
+		Cache_statistics statistics;
+		//! Mutex protecting all the members
+		mutable std::mutex cache_mutex;
+
+	    public:
+
+		/**
+		 * Create an empty cache with no operation enabled
+		 *
+		 * @param capacity_bytes Maximum number of bytes held by the cached results
+		 * @param entries_limit Maximum number of cached results
+		 */
+		explicit Result_cache (const size_t capacity_bytes = size_t{1} << 28, const size_t entries_limit = 1024) :
+		    capacity{capacity_bytes}, max_entries{entries_limit}
+		{}
+
+		///////////////////
+		// CONFIGURATION
+		///////////////////
+		    /**
+		     * @brief Switch caching on or off for an operation
+		     *
+		     * Switching an operation off keeps its cached results until they are evicted.
+		     *
+		     * @param operation Name of the operation
+		     * @param enabled True to cache the results of the operation
+		     */
+		    void enable (const std::string& operation, const bool enabled = true){
+
+			std::lock_guard<std::mutex> lock{cache_mutex};
+			if (enabled)
+			    enabled_operations.insert(operation);
+			else
+			    enabled_operations.erase(operation);
+		    }
+		    /**
+		     * @brief Check if the results of an operation are cached
+		     */
+		    bool is_enabled (const std::string& operation) const {
+
+			std::lock_guard<std::mutex> lock{cache_mutex};
+			return enabled_operations.count(operation) != 0;
+		    }
+		    /**
+		     * @brief Change the limits of the cache, evicting results if needed
+		     *
+		     * @param capacity_bytes Maximum number of bytes held by the cached results
+		     * @param entries_limit Maximum number of cached results
+		     */
+		    void set_capacity (const size_t capacity_bytes, const size_t entries_limit){
+
+			std::lock_guard<std::mutex> lock{cache_mutex};
+			capacity = capacity_bytes;
+			max_entries = entries_limit;
+			evict(0);
+		    }
+		    /**
+		     * @brief Remove all cached results
+		     */
+		    void clear (){
+
+			std::lock_guard<std::mutex> lock{cache_mutex};
+			entries.clear();
+			index.clear();
+			statistics.entries = 0;
+			statistics.size = 0;
+		    }
+
+		///////////////////
+		// STATISTICS
+		///////////////////
+		    /**
+		     * @brief Get the activity counters of the cache
+		     */
+		    Cache_statistics get_statistics () const {
+
+			std::lock_guard<std::mutex> lock{cache_mutex};
+			return statistics;
+		    }
+		    /**
+		     * @brief Reset the hit, miss, insertion and eviction counters
+		     */
+		    void reset_statistics (){
+
+			std::lock_guard<std::mutex> lock{cache_mutex};
+			statistics.hits = statistics.misses = statistics.insertions = statistics.evictions = 0;
+		    }
+
+		///////////////////
+		// MEMOISATION
+		///////////////////
+		    /**
+		     * @brief Get the result of an operation, computing it only if it is not cached
+		     *
+		     * The hashes of the arguments are computed on every call. The lock is not held while f
+		     * runs or while a cached result is copied, so concurrent misses on the same key compute
+		     * the result more than once and keep the first one inserted. Results larger than the
+		     * capacity are not cached.
+		     *
+		     * @param operation Name of the operation
+		     * @param f Function computing the result from the arguments
+		     * @param arguments Matrices and scalars the result depends on
+		     * @returns A copy of the result of f(arguments...)
+		     */
+		    template <typename F, typename... Args>
+		    auto memoize (const std::string& operation, F&& f, const Args&... arguments) -> std::invoke_result_t<F, const Args&...>{
+
+			using R = std::invoke_result_t<F, const Args&...>;
+			if (!is_enabled(operation))
+			    return f(arguments...);
+
+			Key key{operation, {detail::argument_hash(arguments)...}};
+			std::shared_ptr<const R> cached;
+			{
+			    std::lock_guard<std::mutex> lock{cache_mutex};
+			    const auto found = index.find(key);
+			    if (found != index.end() && found->second->type == std::type_index{typeid(R)}){
+
+				++statistics.hits;
+				entries.splice(entries.begin(), entries, found->second);
+				cached = std::static_pointer_cast<const R>(found->second->value);
+			    }
+			    else
+				++statistics.misses;
+			}
+			//copy the result without holding the lock, the shared pointer keeps it alive if evicted
+			if (cached)
+			    return *cached;
+
+			auto result = std::make_shared<const R>(f(arguments...));
+			const size_t size = detail::result_size(*result);
+			std::lock_guard<std::mutex> lock{cache_mutex};
+			if (size <= capacity && max_entries > 0 && index.find(key) == index.end()){
+
+			    evict(size);
+			    entries.push_front(Entry{key, result, std::type_index{typeid(R)}, size});
+			    index.emplace(std::move(key), entries.begin());
+			    ++statistics.insertions;
+			    ++statistics.entries;
+			    statistics.size += size;
+			}
+			return *result;
+		    }
+
+	    private:
+
+		/**
+		 * Remove least recently used results until one of the given size fits
+		 */
+		void evict (const size_t incoming){
+
+		    while (!entries.empty() && (statistics.size + incoming > capacity || entries.size() + (incoming ? 1 : 0) > max_entries)){
+
+			statistics.size -= entries.back().size;
+			index.erase(entries.back().key);
+			entries.pop_back();
+			--statistics.entries;
+			++statistics.evictions;
+		    }
+		}
+	};
+
+	/////////////////////
+	// CACHED OPERATIONS
+	/////////////////////
+	    /**
+	     * @brief Product of two matrices, cached under the operation "multiply"
+	     *
+	     * @param cache The cache to look the result up in
+	     * @param lhs Left operand
+	     * @param rhs Right operand
+	     * @returns lhs*rhs
+	     */
+	    template <typename T, typename L1, typename L2>
+	    Matrix<T, L1> cached_multiply (Result_cache& cache, const Matrix<T, L1>& lhs, const Matrix<T, L2>& rhs){
+
+		return cache.memoize("multiply", [](const Matrix<T, L1>& a, const Matrix<T, L2>& b){ return a*b;}, lhs, rhs);
+	    }
+    }
+}
+
+#endif
@@ -0,0 +1,787 @@
+//: marsh/Task_graph.hpp
+/**
+ * @file marsh/Task_graph.hpp
+ */
+
+#ifndef MARSH_TASK_GRAPH_HPP
+#define MARSH_TASK_GRAPH_HPP
+
+/*
+ * Include headers
+ */
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "../leaq_exceptions.hpp"
+#include "Layouts.hpp"
+#include "Parallel.hpp"
+#include "Thread_pool.hpp"
+#include "Matrix.hpp"
+
+namespace leaqx8664{
+
+    namespace marsh{
+
+	class Task_graph;
+
+	/////////////////////
+	// TASK GRAPH HELPERS
+	/////////////////////
+	namespace detail{
+
+	    //! Number of elements fused element wise nodes compute at a time
+	    constexpr size_t element_block = 256;
+
+	    /**
+	     * Storage for the value computed by a node of a task graph
+	     */
+	    template <typename V>
+	    struct Slot{
+
+		//! The value, empty until computed and after being released
+		std::optional<V> value;
+		//! Promise fulfilled when the value is computed, if a future was requested
+		std::promise<V> promise;
+		//! Future of the promise, valid once requested
+		std::shared_future<V> future;
+	    };
+
+	    /**
+	     * Element wise expression evaluated by blocks: fill(begin, end, out) writes the elements
+	     * [begin, end) of the expression in out. Indices count the storage of non padded layouts
+	     * and the elements by rows for padded ones.
+	     */
+	    template <typename T, typename L>
+	    struct Element_source{
+
+		//! Compute a block of elements
+		std::function<void(size_t, size_t, T*)> fill;
+		//! Shape of the resulting matrix
+		std::pair<size_t, size_t> shape;
+	    };
+
+	    /**
+	     * Storage offset of the element with the given index in an element wise expression
+	     */
+	    template <typename L>
+	    size_t element_offset (const L& layout, const size_t index) noexcept {
+
+		return L::padded ? layout.offset(index) : index;
+	    }
+
+	    /**
+	     * State of a node of a task graph that does not depend on the type of its value
+	     */
+	    struct Node_state{
+
+		//! Nodes whose completion this node waits for
+		std::vector<size_t> inputs;
+		//! Nodes waiting for this node
+		std::vector<size_t> consumers;
+		//! Computes the value of the node
+		std::function<void()> run;
+		//! Reports a failure to the futures of the node
+		std::function<void(std::exception_ptr)> fail;
+		//! Frees the value of the node
+		std::function<void()> release;
+		//! For element wise nodes, a std::function<Element_source<T, L>()> building the expression
+		std::shared_ptr<void> expression;
+		//! True for element wise nodes
+		bool elementwise = false;
+		//! True if a future on the value was requested
+		bool requested = false;
+		//! True if the node is computed as part of its consumer
+		bool fused = false;
+
+		//! Non fused nodes whose values are read, directly or through fused nodes
+		std::vector<size_t> reads;
+		//! Fused nodes computed by this node
+		std::vector<size_t> absorbed;
+		//! Non fused nodes reading the value of this node
+		std::vector<size_t> successors;
+		//! Number of reads still to complete before running
+		std::atomic<size_t> pending{0};
+		//! Number of successors still to run before releasing the value
+		std::atomic<size_t> uses{0};
+		//! Failure of the node or of one of its inputs
+		std::exception_ptr error;
+		//! Fulfilled when the node completes
+		std::promise<void> finished;
+		//! Future of finished
+		std::shared_future<void> finished_future{finished.get_future().share()};
+	    };
+	}
+
+	/////////////////////
+	// TASK HANDLE CLASSES
+	/////////////////////
+
+	/**
+	 * @class Task_handle
+	 *
+	 * @brief Handle to a node of a Task_graph
+	 *
+	 * Handles are used to declare dependencies between nodes. Nodes computing a value
+	 * are referred to by the derived Node class.
+	 */
+	class Task_handle{
+
+	    friend class Task_graph;
+
+	    protected:
+
+		//! Index of the node in its graph
+		size_t id;
+
+		explicit Task_handle (const size_t node_id) noexcept : id{node_id} {}
+
+	    public:
+
+		//! Get the index of the node in its graph
+		size_t get_id() const noexcept { return id;}
+	};
+
+	/**
+	 * @class Node
+	 *
+	 * @brief Handle to a node of a Task_graph computing a value of type V
+	 */
+	template <typename V>
+	class Node : public Task_handle{
+
+	    friend class Task_graph;
+
+	    //! Storage of the value
+	    std::shared_ptr<detail::Slot<V>> slot;
+
+	    Node (const size_t node_id, std::shared_ptr<detail::Slot<V>> value_slot) :
+		Task_handle{node_id}, slot{std::move(value_slot)}
+	    {}
+
+	    public:
+
+		//! Alias for the type of the computed value
+		using value_type = V;
+	};
+
+	/////////////////////
+	// TASK GRAPH CLASS
+	/////////////////////
+
+	/**
+	 * @class Task_graph
+	 *
+	 * @brief Directed acyclic graph of matrix operations executed asynchronously
+	 *
+	 * Operations added to the graph return Node handles instead of values; a node can be used
+	 * as input of later operations, which builds the dependency graph. run() submits every node
+	 * whose inputs are ready to a Thread_pool, so independent operations overlap, and futures
+	 * requested with future() become ready as soon as their node completes.
+	 *
+	 * Before running, chains of element wise nodes whose only consumer is another element wise
+	 * node are fused: the consumer computes them block by block, without allocating the
+	 * intermediate matrices. The value of every other node is freed as soon as its last consumer
+	 * has run, unless a future was requested for it.
+	 *
+	 * Exceptions thrown by an operation are stored in its futures and in the futures of all
+	 * the nodes depending on it. A graph can be run once, and waits for its nodes on destruction.
+	 */
+	class Task_graph{
+
+	    ////////////////////////////////
+	    // DATA MEMBERS DECLARATIONS
+	    ////////////////////////////////
+		//! Nodes of the graph
+		std::vector<std::unique_ptr<detail::Node_state>> nodes;
+		//! Number of nodes to run
+		size_t to_run = 0;
+		//! Number of nodes completed
+		size_t completed = 0;
+		//! Mutex protecting completed
+		std::mutex completed_mutex;
+		//! Signalled when all nodes have completed
+		std::condition_variable all_completed;
+		//! True once run has been called
+		bool started = false;
+
+	    public:
+
+		Task_graph () = default;
+		//! Graphs can not be copied
+		Task_graph (const Task_graph&) = delete;
+		//! Graphs can not be copied
+		Task_graph& operator= (const Task_graph&) = delete;
+		/**
+		 * @brief Destructor for the Task_graph class
+		 *
+		 * Wait for the running nodes to complete.
+		 */
+		~Task_graph(){
+
+		    wait();
+		}
+
+		///////////////////
+		// NODE CREATION MEMBERS
+		///////////////////
+		    /**
+		     * @brief Add a node holding the given value
+		     *
+		     * @param value The value, moved in the graph
+		     * @returns The node holding the value
+		     */
+		    template <typename V>
+		    Node<V> input (V value){
+
+			auto slot = std::make_shared<detail::Slot<V>>();
+			slot->value.emplace(std::move(value));
+			const size_t id = add_node({});
+			set_value_callbacks(id, slot, [](){});
+			return Node<V>{id, slot};
+		    }
+		    /**
+		     * @brief Add a node computing f on the values of the given nodes
+		     *
+		     * @param f Function called with const references to the input values
+		     * @param arguments Nodes whose values are passed to f
+		     * @returns The node holding the value returned by f
+		     */
+		    template <typename F, typename... Args>
+		    auto apply (F f, const Node<Args>&... arguments) -> Node<std::invoke_result_t<F, const Args&...>>{
+
+			using R = std::invoke_result_t<F, const Args&...>;
+			auto slot = std::make_shared<detail::Slot<R>>();
+			const size_t id = add_node({arguments.id...});
+			set_value_callbacks(id, slot, [slot, f, input_slots = std::make_tuple(arguments.slot...)](){
+			    slot->value.emplace(std::apply([&f](const auto&... inputs){ return f(*inputs->value...);}, input_slots));
+			});
+			return Node<R>{id, slot};
+		    }
+		    /**
+		     * @brief Add a node computing the product of two matrices
+		     *
+		     * @param lhs Node holding the left operand
+		     * @param rhs Node holding the right operand
+		     * @returns The node holding lhs*rhs
+		     */
+		    template <typename T, typename L1, typename L2>
+		    Node<Matrix<T, L1>> multiply (const Node<Matrix<T, L1>>& lhs, const Node<Matrix<T, L2>>& rhs){
+
+			return apply([](const Matrix<T, L1>& a, const Matrix<T, L2>& b){ return a*b;}, lhs, rhs);
+		    }
+		    /**
+		     * @brief Add a node applying f to the elements of matrices with the same shape
+		     *
+		     * Element wise nodes are fused with their consumer when it is an element wise node too
+		     * and no other node or future needs their value.
+		     *
+		     * @param f Function computing an element of the result from the elements of the inputs
+		     * @param first Node holding the first input
+		     * @param others Nodes holding the other inputs
+		     * @returns The node holding the matrix of f(first(i), others(i)...)
+		     *
+		     * Running the node stores a ShapeMismatchException in its futures if the inputs have different shapes.
+		     */
+		    template <typename F, typename T, typename L, typename... Others>
+		    Node<Matrix<T, L>> elementwise (F f, const Node<Matrix<T, L>>& first, const Node<Others>&... others){
+
+			static_assert((std::is_same<Others, Matrix<T, L>>::value && ...), "element wise inputs must have the same type");
+			constexpr size_t n_inputs = 1 + sizeof...(Others);
+			using source = detail::Element_source<T, L>;
+			using builder = std::function<source()>;
+
+			std::array<size_t, n_inputs> ids{first.id, others.id...};
+			std::array<std::shared_ptr<detail::Slot<Matrix<T, L>>>, n_inputs> slots{first.slot, others.slot...};
+			std::array<detail::Node_state*, n_inputs> states;
+			for (size_t k = 0; k < n_inputs; ++k)
+			    states[k] = nodes[ids[k]].get();
+
+			//the expression reads fused inputs through their own expression and the others from their value
+			auto expression = std::make_shared<builder>([f, slots, states](){
+			    std::array<source, n_inputs> sources;
+			    for (size_t k = 0; k < n_inputs; ++k){
+
+				if (states[k]->fused)
+				    sources[k] = (*std::static_pointer_cast<builder>(states[k]->expression))();
+				else{
+
+				    const auto input = slots[k];
+				    sources[k].shape = input->value->get_shape();
+				    sources[k].fill = [input](size_t begin, size_t end, T* out){
+					const T* data = input->value->data();
+					const L& layout = input->value->get_layout();
+					for (size_t i = begin; i < end; ++i)
+					    out[i - begin] = data[detail::element_offset(layout, i)];
+				    };
+				}
+				if (sources[k].shape != sources[0].shape)
+				    throw ShapeMismatchException{};
+			    }
+
+			    source result;
+			    result.shape = sources[0].shape;
+			    result.fill = [f, sources](size_t begin, size_t end, T* out){
+				std::array<std::array<T, detail::element_block>, n_inputs> buffers;
+				for (size_t k = 0; k < n_inputs; ++k)
+				    sources[k].fill(begin, end, buffers[k].data());
+				for (size_t i = 0; i < end - begin; ++i)
+				    out[i] = call_elementwise(f, buffers, i, std::make_index_sequence<n_inputs>{});
+			    };
+			    return result;
+			});
+
+			auto slot = std::make_shared<detail::Slot<Matrix<T, L>>>();
+			const size_t id = add_node(std::vector<size_t>(ids.begin(), ids.end()));
+			nodes[id]->elementwise = true;
+			nodes[id]->expression = expression;
+			set_value_callbacks(id, slot, [slot, expression](){
+			    const source computed = (*expression)();
+			    Matrix<T, L> result{computed.shape.first, computed.shape.second};
+			    const size_t n_elements = L::padded ? computed.shape.first*computed.shape.second : result.get_layout().storage_size();
+			    const size_t n_blocks = (n_elements + detail::element_block - 1) / detail::element_block;
+			    parallel_for(0, n_blocks, 64, [&](size_t, size_t block_begin, size_t block_end){
+				std::array<T, detail::element_block> buffer;
+				for (size_t b = block_begin; b < block_end; ++b){
+
+				    const size_t begin = b*detail::element_block;
+				    const size_t end = std::min(begin + detail::element_block, n_elements);
+				    if (L::padded){
+
+					computed.fill(begin, end, buffer.data());
+					for (size_t i = begin; i < end; ++i)
+					    result.data()[detail::element_offset(result.get_layout(), i)] = buffer[i - begin];
+				    }
+				    else
+					computed.fill(begin, end, result.data() + begin);
+				}
+			    });
+			    slot->value.emplace(std::move(result));
+			});
+			return Node<Matrix<T, L>>{id, slot};
+		    }
+		    /**
+		     * @brief Add a node computing the element wise sum of two matrices
+		     */
+		    template <typename T, typename L>
+		    Node<Matrix<T, L>> add (const Node<Matrix<T, L>>& lhs, const Node<Matrix<T, L>>& rhs){
+
+			return elementwise([](const T& x, const T& y){ return x + y;}, lhs, rhs);
+		    }
+		    /**
+		     * @brief Add a node computing the element wise difference of two matrices
+		     */
+		    template <typename T, typename L>
+		    Node<Matrix<T, L>> subtract (const Node<Matrix<T, L>>& lhs, const Node<Matrix<T, L>>& rhs){
+
+			return elementwise([](const T& x, const T& y){ return x - y;}, lhs, rhs);
+		    }
+		    /**
+		     * @brief Add a node multiplying the elements of a matrix by a scalar
+		     */
+		    template <typename T, typename L>
+		    Node<Matrix<T, L>> scale (const typename Matrix<T, L>::scalar_type alpha, const Node<Matrix<T, L>>& matrix){
+
+			return elementwise([alpha](const T& x){ return alpha*x;}, matrix);
+		    }
+		    /**
+		     * @brief Add a node running f after the given nodes
+		     *
+		     * Tasks compute no value: they act on data they capture, such as blocks of a
+		     * Matrix, and their ordering is given by the dependencies.
+		     *
+		     * @param f Function to run
+		     * @param dependencies Nodes that must complete before f runs
+		     * @returns The handle of the task
+		     */
+		    template <typename F>
+		    Task_handle task (F f, const std::vector<Task_handle>& dependencies = {}){
+
+			std::vector<size_t> ids;
+			for (const auto& dependency : dependencies)
+			    ids.push_back(dependency.id);
+			const size_t id = add_node(std::move(ids));
+			nodes[id]->run = std::move(f);
+			nodes[id]->fail = [](std::exception_ptr){};
+			nodes[id]->release = [](){};
+			return Task_handle{id};
+		    }
+
+		///////////////////
+		// FUTURES
+		///////////////////
+		    /**
+		     * @brief Get a future on the value of a node
+		     *
+		     * Must be called before run(). The node keeps a copy of its value until all of
+		     * its consumers have run.
+		     *
+		     * @param node The node
+		     * @returns A future that becomes ready when the node completes
+		     */
+		    template <typename V>
+		    std::shared_future<V> future (const Node<V>& node){
+
+			nodes[node.id]->requested = true;
+			if (!node.slot->future.valid())
+			    node.slot->future = node.slot->promise.get_future().share();
+			return node.slot->future;
+		    }
+		    /**
+		     * @brief Get a future that becomes ready when a node completes
+		     *
+		     * @param node The node
+		     * @returns A future that becomes ready, or stores the failure of the node, when it completes
+		     */
+		    std::shared_future<void> completion (const Task_handle& node) const {
+
+			return nodes[node.id]->finished_future;
+		    }
+
+		///////////////////
+		// EXECUTION
+		///////////////////
+		    /**
+		     * @brief Start the execution of the graph
+		     *
+		     * Fuse element wise nodes, then submit to the pool every node without pending
+		     * inputs; each completing node submits the successors it made ready. The call
+		     * returns immediately, use futures or wait() to get the results. The pool must
+		     * outlive the execution.
+		     *
+		     * @param pool The pool running the nodes
+		     */
+		    void run (Thread_pool& pool){
+
+			if (started)
+			    return;
+			started = true;
+			prepare();
+			//roots are collected first: running nodes already update the pending counters
+			std::vector<size_t> roots;
+			for (size_t id = 0; id < nodes.size(); ++id)
+			    if (!nodes[id]->fused && nodes[id]->pending == 0)
+				roots.push_back(id);
+			for (const auto root : roots)
+			    submit(pool, root);
+		    }
+		    /**
+		     * @brief Wait for all nodes to complete
+		     */
+		    void wait (){
+
+			std::unique_lock<std::mutex> lock{completed_mutex};
+			all_completed.wait(lock, [this](){ return !started || completed == to_run;});
+		    }
+
+	    private:
+
+		/**
+		 * Append a node waiting for the given inputs
+		 */
+		size_t add_node (std::vector<size_t> inputs){
+
+		    const size_t id = nodes.size();
+		    nodes.emplace_back(new detail::Node_state{});
+		    for (const auto input : inputs)
+			nodes[input]->consumers.push_back(id);
+		    nodes[id]->inputs = std::move(inputs);
+		    return id;
+		}
+		/**
+		 * Set the callbacks of a node computing a value in slot through compute
+		 */
+		template <typename V, typename C>
+		void set_value_callbacks (const size_t id, const std::shared_ptr<detail::Slot<V>>& slot, C compute){
+
+		    detail::Node_state* state = nodes[id].get();
+		    state->run = [state, slot, compute](){
+			compute();
+			if (state->requested){
+
+			    //the value can be moved to the future when no successor needs it
+			    if (state->uses == 0){
+
+				slot->promise.set_value(std::move(*slot->value));
+				slot->value.reset();
+			    }
+			    else
+				slot->promise.set_value(*slot->value);
+			}
+		    };
+		    state->fail = [state, slot](std::exception_ptr error){
+			if (state->requested)
+			    slot->promise.set_exception(error);
+		    };
+		    state->release = [slot](){ slot->value.reset();};
+		}
+		/**
+		 * Call f on the i-th element of every buffer
+		 */
+		template <typename F, typename B, size_t... K>
+		static auto call_elementwise (F& f, const B& buffers, const size_t i, std::index_sequence<K...>){
+
+		    return f(buffers[K][i]...);
+		}
+		/**
+		 * Fuse element wise chains and compute reads, successors and counters of the nodes
+		 */
+		void prepare (){
+
+		    for (auto& node : nodes){
+
+			node->fused = node->elementwise && !node->requested && node->consumers.size() == 1
+			    && nodes[node->consumers[0]]->elementwise;
+		    }
+		    for (size_t id = 0; id < nodes.size(); ++id){
+
+			auto& node = *nodes[id];
+			if (node.fused)
+			    continue;
+			++to_run;
+			collect_reads(node, node);
+			std::sort(node.reads.begin(), node.reads.end());
+			node.reads.erase(std::unique(node.reads.begin(), node.reads.end()), node.reads.end());
+			node.pending = node.reads.size();
+			for (const auto read : node.reads){
+
+			    nodes[read]->successors.push_back(id);
+			    ++nodes[read]->uses;
+			}
+		    }
+		}
+		/**
+		 * Add to target the reads of node, looking through fused inputs
+		 */
+		void collect_reads (detail::Node_state& target, const detail::Node_state& node){
+
+		    for (const auto input : node.inputs){
+
+			if (nodes[input]->fused){
+
+			    target.absorbed.push_back(input);
+			    collect_reads(target, *nodes[input]);
+			}
+			else
+			    target.reads.push_back(input);
+		    }
+		}
+		/**
+		 * Queue the execution of a node
+		 */
+		void submit (Thread_pool& pool, const size_t id){
+
+		    pool.submit([this, &pool, id](){ execute(pool, id);});
+		}
+		/**
+		 * Run a node, release the values it no longer needs and submit its ready successors
+		 */
+		void execute (Thread_pool& pool, const size_t id){
+
+		    auto& node = *nodes[id];
+		    for (const auto read : node.reads)
+			if (nodes[read]->error)
+			    node.error = nodes[read]->error;
+		    if (!node.error){
+
+			try{
+			    node.run();
+			}
+			catch (...){
+			    node.error = std::current_exception();
+			}
+		    }
+		    if (node.error)
+			node.fail(node.error);
+		    if (node.uses == 0)
+			node.release();
+
+		    for (const auto absorbed : node.absorbed)
+			finish(*nodes[absorbed], node.error);
+		    finish(node, node.error);
+		    for (const auto read : node.reads)
+			if (--nodes[read]->uses == 0)
+			    nodes[read]->release();
+		    for (const auto successor : node.successors)
+			if (--nodes[successor]->pending == 0)
+			    submit(pool, successor);
+
+		    std::lock_guard<std::mutex> lock{completed_mutex};
+		    if (++completed == to_run)
+			all_completed.notify_all();
+		}
+		/**
+		 * Fulfil the completion future of a node
+		 */
+		static void finish (detail::Node_state& node, const std::exception_ptr& error){
+
+		    if (error)
+			node.finished.set_exception(error);
+		    else
+			node.finished.set_value();
+		}
+	};
+
+	/////////////////////
+	// TILED FACTORISATIONS
+	/////////////////////
+	namespace detail{
+
+	    /**
+	     * Unchecked access to the elements of a block through the storage of its matrix.
+	     * The content hash of the matrix is invalidated once, when the access is created.
+	     */
+	    template <typename B>
+	    auto block_elements (const B& block){
+
+		auto& matrix = block.get_matrix();
+		auto* data = matrix.data();
+		const auto* layout = &matrix.get_layout();
+		const size_t first_row = block.get_first_row(), first_column = block.get_first_column();
+		return [data, layout, first_row, first_column](size_t i, size_t j) -> decltype(*data) {
+		    return data[layout->offset(first_row + i, first_column + j)];
+		};
+	    }
+	    /**
+	     * Cholesky factorisation of the lower triangle of a diagonal block
+	     */
+	    template <typename B>
+	    void block_cholesky (const B& block){
+
+		const auto a = block_elements(block);
+		using T = typename std::remove_reference<decltype(a(0, 0))>::type;
+		const size_t n = block.get_shape().first;
+		for (size_t j = 0; j < n; ++j){
+
+		    T diagonal = a(j, j);
+		    for (size_t k = 0; k < j; ++k)
+			diagonal -= a(j, k)*a(j, k);
+		    if (!(diagonal > T{}))
+			throw SingularMatrixException{};
+		    a(j, j) = std::sqrt(diagonal);
+		    for (size_t i = j + 1; i < n; ++i){
+
+			T value = a(i, j);
+			for (size_t k = 0; k < j; ++k)
+			    value -= a(i, k)*a(j, k);
+			a(i, j) = value/a(j, j);
+		    }
+		}
+	    }
+	    /**
+	     * b = b*l^-T for the lower triangular block l
+	     */
+	    template <typename B>
+	    void block_solve_transposed (const B& l_block, const B& b_block){
+
+		const auto l = block_elements(l_block);
+		const auto b = block_elements(b_block);
+		for (size_t r = 0; r < b_block.get_shape().first; ++r)
+		    for (size_t j = 0; j < b_block.get_shape().second; ++j){
+
+			auto value = b(r, j);
+			for (size_t k = 0; k < j; ++k)
+			    value -= b(r, k)*l(j, k);
+			b(r, j) = value/l(j, j);
+		    }
+	    }
+	    /**
+	     * c -= a*b^T, only on the lower triangle when lower is set
+	     */
+	    template <typename B>
+	    void block_update (const B& a_block, const B& b_block, const B& c_block, const bool lower){
+
+		const auto a = block_elements(a_block);
+		const auto b = block_elements(b_block);
+		const auto c = block_elements(c_block);
+		const size_t inner = a_block.get_shape().second;
+		for (size_t i = 0; i < c_block.get_shape().first; ++i)
+		    for (size_t j = 0; j < (lower ? i + 1 : c_block.get_shape().second); ++j){
+
+			auto value = c(i, j);
+			for (size_t k = 0; k < inner; ++k)
+			    value -= a(i, k)*b(j, k);
+			c(i, j) = value;
+		    }
+	    }
+	}
+	    /**
+	     * @brief Add to a graph the tile tasks of a Cholesky factorisation
+	     *
+	     * The square matrix a is split in tiles of tile x tile elements and the tasks factorising
+	     * diagonal tiles, solving the tiles below them and updating the trailing tiles are added to
+	     * the graph, each depending on the tasks that last wrote the tiles it uses. Once the graph has
+	     * run, the lower triangle of a holds the factor l such that a = l*l^T; the strictly upper
+	     * triangle is not modified. a must outlive the execution of the graph.
+	     *
+	     * @param graph The graph receiving the tasks
+	     * @param a A symmetric positive definite matrix
+	     * @param tile Side of the tiles
+	     * @returns The task computing the last tile of the factor
+	     *
+	     * @throws ShapeMismatchException if a is not square.
+	     * @throws std::invalid_argument if tile is 0.
+	     *
+	     * Running the graph stores a SingularMatrixException in the tasks if a is not positive definite.
+	     */
+	    template <typename T, typename L>
+	    Task_handle tiled_cholesky (Task_graph& graph, Matrix<T, L>& a, const size_t tile){
+
+		const size_t n = a.get_shape().first;
+		if (a.get_shape().second != n || n == 0)
+		    throw ShapeMismatchException{};
+		if (tile == 0)
+		    throw std::invalid_argument{"tiled_cholesky: tile must be positive"};
+
+		const size_t n_tiles = (n + tile - 1) / tile;
+		auto tile_of = [&a, n, tile](size_t i, size_t j){
+		    return a.get_block(i*tile, j*tile, std::min(tile, n - i*tile), std::min(tile, n - j*tile));
+		};
+		//last task writing each tile, tiles not written yet depend on a no-op task
+		const Task_handle start = graph.task([](){});
+		std::vector<std::vector<Task_handle>> writers(n_tiles, std::vector<Task_handle>(n_tiles, start));
+		auto depend = [&writers](std::initializer_list<std::pair<size_t, size_t>> tiles){
+		    std::vector<Task_handle> dependencies;
+		    for (const auto& t : tiles)
+			dependencies.push_back(writers[t.first][t.second]);
+		    return dependencies;
+		};
+
+		Task_handle last = start;
+		for (size_t k = 0; k < n_tiles; ++k){
+
+		    auto diagonal = tile_of(k, k);
+		    last = graph.task([diagonal](){ detail::block_cholesky(diagonal);}, depend({{k, k}}));
+		    writers[k][k] = last;
+
+		    for (size_t i = k + 1; i < n_tiles; ++i){
+
+			auto below = tile_of(i, k);
+			writers[i][k] = graph.task([diagonal, below](){ detail::block_solve_transposed(diagonal, below);}, depend({{k, k}, {i, k}}));
+		    }
+		    for (size_t i = k + 1; i < n_tiles; ++i)
+			for (size_t j = k + 1; j <= i; ++j){
+
+			    auto left = tile_of(i, k), right = tile_of(j, k), target = tile_of(i, j);
+			    writers[i][j] = graph.task([left, right, target, i, j](){ detail::block_update(left, right, target, i == j);},
+				depend({{i, k}, {j, k}, {i, j}}));
+			}
+		}
+		return last;
+	    }
+    }
+}
+
+#endif
@@ -0,0 +1,168 @@
+//: marsh/Thread_pool.hpp
+/**
+ * @file marsh/Thread_pool.hpp
+ */
+
+#ifndef MARSH_THREAD_POOL_HPP
+#define MARSH_THREAD_POOL_HPP
+
+/*
+ * Include headers
+ */
+#include <atomic>
+#include <cstddef>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace leaqx8664{
+
+    namespace marsh{
+
+	/////////////////////
+	// THREAD COUNT
+	/////////////////////
+	    /**
+	     * Storage for the number of threads used by parallel kernels, initialized
+	     * to the number of hardware threads.
+	     */
+	    inline std::atomic<size_t>& thread_count_setting(){
+
+		static std::atomic<size_t> n_threads{std::thread::hardware_concurrency() ? std::thread::hardware_concurrency() : 1};
+		return n_threads;
+	    }
+	    /**
+	     * @brief Get the number of threads used by parallel kernels
+	     *
+	     * @returns The maximum number of threads a kernel splits its work in
+	     */
+	    inline size_t get_num_threads() noexcept {
+
+		return thread_count_setting().load(std::memory_order_relaxed);
+	    }
+	    /**
+	     * @brief Set the number of threads used by parallel kernels
+	     *
+	     * Results of parallel reductions only depend on the number of threads, so
+	     * fixing it makes them reproducible. Kernels already running keep the number
+	     * of threads they started with.
+	     *
+	     * @param n_threads The number of threads, 0 is treated as 1
+	     */
+	    inline void set_num_threads(const size_t n_threads) noexcept {
+
+		thread_count_setting().store(n_threads ? n_threads : 1, std::memory_order_relaxed);
+	    }
+
+	/////////////////////
+	// THREAD POOL CLASS
+	/////////////////////
+
+	/**
+	 * @class Thread_pool
+	 *
+	 * @brief Fixed set of worker threads running submitted jobs in FIFO order
+	 *
+	 * Jobs must not throw: callers that need to report errors catch them inside the job.
+	 * The destructor waits for all submitted jobs to complete.
+	 */
+	class Thread_pool{
+
+	    ////////////////////////////////
+	    // DATA MEMBERS DECLARATIONS
+	    ////////////////////////////////
+		//! Worker threads
+		std::vector<std::thread> workers;
+		//! Jobs waiting for a worker
+		std::queue<std::function<void()>> jobs;
+		//! Mutex protecting jobs and stopping
+		std::mutex jobs_mutex;
+		//! Signalled when a job is submitted or the pool stops
+		std::condition_variable jobs_available;
+		//! True when the pool is being destroyed
+		bool stopping = false;
+
+	    public:
+
+		/**
+		 * Create a pool with the given number of workers
+		 *
+		 * @param n_workers Number of worker threads, 0 uses get_num_threads()
+		 */
+		explicit Thread_pool (const size_t n_workers = 0){
+
+		    const size_t count = n_workers ? n_workers : get_num_threads();
+		    workers.reserve(count);
+		    for (size_t i = 0; i < count; ++i)
+			workers.emplace_back([this](){ work();});
+		}
+		//! Pools can not be copied
+		Thread_pool (const Thread_pool&) = delete;
+		//! Pools can not be copied
+		Thread_pool& operator= (const Thread_pool&) = delete;
+		/**
+		 * @brief Destructor for the Thread_pool class
+		 *
+		 * Run the jobs still queued and join the workers.
+		 */
+		~Thread_pool(){
+
+		    {
+			std::lock_guard<std::mutex> lock{jobs_mutex};
+			stopping = true;
+		    }
+		    jobs_available.notify_all();
+		    for (auto& worker : workers)
+			worker.join();
+		}
+
+		/**
+		 * @brief Queue a job for execution
+		 *
+		 * @param job Function to run on one of the workers
+		 */
+		void submit (std::function<void()> job){
+
+		    {
+			std::lock_guard<std::mutex> lock{jobs_mutex};
+			jobs.push(std::move(job));
+		    }
+		    jobs_available.notify_one();
+		}
+		/**
+		 * @brief Get the number of workers
+		 *
+		 * @returns The number of worker threads
+		 */
+		size_t get_size() const noexcept { return workers.size();}
+
+	    private:
+
+		/**
+		 * Body of the workers: run jobs until the pool stops and the queue is empty
+		 */
+		void work (){
+
+		    for (;;){
+
+			std::function<void()> job;
+			{
+			    std::unique_lock<std::mutex> lock{jobs_mutex};
+			    jobs_available.wait(lock, [this](){ return stopping || !jobs.empty();});
+			    if (jobs.empty())
+				return;
+			    job = std::move(jobs.front());
+			    jobs.pop();
+			}
+			job();
+		    }
+		}
+	};
+    }
+}
+
+#endif
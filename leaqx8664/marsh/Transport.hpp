@@ -0,0 +1,610 @@
+//: marsh/Transport.hpp
+/**
+ * @file marsh/Transport.hpp
+ */
+
+#ifndef MARSH_TRANSPORT_HPP
+#define MARSH_TRANSPORT_HPP
+
+/*
+ * Include headers
+ */
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <cerrno>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "../leaq_exceptions.hpp"
+#include "Parallel.hpp"
+
+namespace leaqx8664{
+
+    namespace marsh{
+
+	/////////////////////
+	// TRANSPORT INTERFACE
+	/////////////////////
+
+	/**
+	 * @struct Communication_statistics
+	 *
+	 * @brief Communication counters of one process
+	 */
+	struct Communication_statistics{
+
+	    //! Bytes of payload sent
+	    std::uint64_t bytes_sent = 0;
+	    //! Bytes of payload received
+	    std::uint64_t bytes_received = 0;
+	    //! Number of messages sent
+	    std::uint64_t messages_sent = 0;
+	    //! Number of messages received
+	    std::uint64_t messages_received = 0;
+	    //! Seconds spent in send and receive calls, including the wait for incoming data
+	    double communication_time = 0;
+	};
+
+	/**
+	 * @class Transport
+	 *
+	 * @brief Point to point messaging between the processes of a group
+	 *
+	 * Processes are identified by their rank in [0, get_size()). Messages between two processes
+	 * are received in the order they were sent, and a receive must ask for the size of the
+	 * matching message. Sends do not wait for the matching receive, so exchanges where every
+	 * process sends before receiving do not deadlock.
+	 *
+	 * Backends implement the protected deliver and collect members; the public members count
+	 * the traffic and the time spent communicating. A transport may be used by several threads,
+	 * provided only one of them receives from a given source at a time.
+	 */
+	class Transport{
+
+	    ////////////////////////////////
+	    // DATA MEMBERS DECLARATIONS
+	    ////////////////////////////////
+		//! Counters of this process
+		Communication_statistics statistics;
+		//! Mutex protecting statistics
+		mutable std::mutex statistics_mutex;
+
+	    public:
+
+		virtual ~Transport() = default;
+
+		//! Get the rank of this process
+		virtual size_t get_rank() const noexcept = 0;
+		//! Get the number of processes
+		virtual size_t get_size() const noexcept = 0;
+
+		/**
+		 * @brief Send a message
+		 *
+		 * The data is copied before the call returns.
+		 *
+		 * @param destination Rank of the receiving process, possibly this one
+		 * @param data Pointer to the message
+		 * @param bytes Size of the message
+		 *
+		 * @throws IndexOutOfBoundsException if destination is not a valid rank.
+		 */
+		void send (const size_t destination, const void* data, const size_t bytes){
+
+		    if (destination >= get_size())
+			throw IndexOutOfBoundsException{};
+		    const auto start = std::chrono::steady_clock::now();
+		    deliver(destination, data, bytes);
+		    record(start, bytes, true);
+		}
+		/**
+		 * @brief Receive a message
+		 *
+		 * Wait until the next message from source is available.
+		 *
+		 * @param source Rank of the sending process, possibly this one
+		 * @param data Pointer to the buffer receiving the message
+		 * @param bytes Size of the message
+		 *
+		 * @throws IndexOutOfBoundsException if source is not a valid rank.
+		 * @throws CommunicationException if the message has another size, which discards it, source has exited
+		 * or the transport failed.
+		 */
+		void receive (const size_t source, void* data, const size_t bytes){
+
+		    if (source >= get_size())
+			throw IndexOutOfBoundsException{};
+		    const auto start = std::chrono::steady_clock::now();
+		    collect(source, data, bytes);
+		    record(start, bytes, false);
+		}
+		/**
+		 * @brief Send the elements of a vector
+		 */
+		template <typename T>
+		void send (const size_t destination, const std::vector<T>& values){
+
+		    send(destination, values.data(), values.size()*sizeof(T));
+		}
+		/**
+		 * @brief Receive elements in a vector, whose size gives the expected number of elements
+		 */
+		template <typename T>
+		void receive (const size_t source, std::vector<T>& values){
+
+		    receive(source, values.data(), values.size()*sizeof(T));
+		}
+		/**
+		 * @brief Wait until every process has called barrier
+		 */
+		void barrier (){
+
+		    char token = 0;
+		    if (get_rank() == 0){
+
+			for (size_t r = 1; r < get_size(); ++r)
+			    receive(r, &token, 1);
+			for (size_t r = 1; r < get_size(); ++r)
+			    send(r, &token, 1);
+		    }
+		    else{
+
+			send(0, &token, 1);
+			receive(0, &token, 1);
+		    }
+		}
+
+		/**
+		 * @brief Get the communication counters of this process
+		 */
+		Communication_statistics get_statistics() const {
+
+		    std::lock_guard<std::mutex> lock{statistics_mutex};
+		    return statistics;
+		}
+		/**
+		 * @brief Reset the communication counters of this process
+		 */
+		void reset_statistics(){
+
+		    std::lock_guard<std::mutex> lock{statistics_mutex};
+		    statistics = Communication_statistics{};
+		}
+
+	    protected:
+
+		//! Queue a message for destination
+		virtual void deliver (size_t destination, const void* data, size_t bytes) = 0;
+		//! Wait for the next message from source and copy it to data
+		virtual void collect (size_t source, void* data, size_t bytes) = 0;
+
+	    private:
+
+		/**
+		 * Count a completed send or receive
+		 */
+		void record (const std::chrono::steady_clock::time_point start, const size_t bytes, const bool sent){
+
+		    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+		    std::lock_guard<std::mutex> lock{statistics_mutex};
+		    statistics.communication_time += elapsed.count();
+		    if (sent){
+
+			statistics.bytes_sent += bytes;
+			++statistics.messages_sent;
+		    }
+		    else{
+
+			statistics.bytes_received += bytes;
+			++statistics.messages_received;
+		    }
+		}
+	};
+
+	    /**
+	     * @brief Collect the communication counters of all processes
+	     *
+	     * Must be called by every process of the transport.
+	     *
+	     * @param transport The transport
+	     * @param root Rank receiving the counters
+	     * @returns The counters of every rank on root, an empty vector on the other processes
+	     */
+	    inline std::vector<Communication_statistics> gather_statistics (Transport& transport, const size_t root = 0){
+
+		const Communication_statistics own = transport.get_statistics();
+		if (transport.get_rank() != root){
+
+		    transport.send(root, &own, sizeof(own));
+		    return {};
+		}
+		std::vector<Communication_statistics> all(transport.get_size());
+		for (size_t r = 0; r < all.size(); ++r){
+
+		    if (r == root)
+			all[r] = own;
+		    else
+			transport.receive(r, &all[r], sizeof(all[r]));
+		}
+		return all;
+	    }
+
+	/////////////////////
+	// UNIX SOCKET TRANSPORT
+	/////////////////////
+
+	/**
+	 * @class Socket_transport
+	 *
+	 * @brief Transport between local processes connected by Unix domain socket pairs
+	 *
+	 * Every pair of processes shares a stream socket. A progress thread polls the sockets,
+	 * writing queued messages as the peers accept them and buffering incoming data, so
+	 * communication proceeds while the calling threads compute. Messages are framed with their
+	 * size. The destructor waits until all queued messages have been written.
+	 */
+	class Socket_transport : public Transport{
+
+	    /**
+	     * Byte queue with amortised removal from the front
+	     */
+	    struct Byte_queue{
+
+		std::vector<char> bytes;
+		size_t first = 0;
+
+		size_t size() const noexcept { return bytes.size() - first;}
+		const char* front() const noexcept { return bytes.data() + first;}
+		void append(const void* data, const size_t n){
+
+		    const char* begin = static_cast<const char*>(data);
+		    bytes.insert(bytes.end(), begin, begin + n);
+		}
+		void pop(const size_t n){
+
+		    first += n;
+		    if (first == bytes.size()){
+
+			bytes.clear();
+			first = 0;
+		    }
+		    else if (first > (size_t{1} << 20) && first > bytes.size() / 2){
+
+			bytes.erase(bytes.begin(), bytes.begin() + first);
+			first = 0;
+		    }
+		}
+	    };
+
+	    ////////////////////////////////
+	    // DATA MEMBERS DECLARATIONS
+	    ////////////////////////////////
+		//! Rank of this process
+		size_t rank;
+		//! Socket connected to each process, -1 for this one
+		std::vector<int> sockets;
+		//! Pipe waking the progress thread when a message is queued
+		int wake_pipe[2];
+		//! Messages waiting to be written, by destination
+		std::vector<Byte_queue> outgoing;
+		//! Data received and not yet collected, by source
+		std::vector<Byte_queue> incoming;
+		//! True for sources whose socket has been closed or can no longer be polled
+		std::vector<bool> closed;
+		//! True when the transport is being destroyed
+		bool stopping = false;
+		//! Mutex protecting the queues and flags
+		std::mutex queues_mutex;
+		//! Signalled when data arrives or a socket closes
+		std::condition_variable data_arrived;
+		//! Thread moving data between the queues and the sockets
+		std::thread progress_thread;
+
+	    public:
+
+		/**
+		 * Create the transport of a process from its connected sockets
+		 *
+		 * @param process_rank Rank of this process
+		 * @param peer_sockets Socket connected to each process, ignored at index process_rank;
+		 * the transport takes ownership of the sockets
+		 *
+		 * @throws CommunicationException if the sockets can not be configured.
+		 */
+		Socket_transport (const size_t process_rank, std::vector<int> peer_sockets) :
+		    rank{process_rank}, sockets{std::move(peer_sockets)}, outgoing(sockets.size()), incoming(sockets.size()), closed(sockets.size(), false)
+		{
+		    sockets[rank] = -1;
+		    if (pipe(wake_pipe) != 0)
+			throw CommunicationException{};
+		    for (const int fd : sockets)
+			if (fd >= 0 && fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK) != 0)
+			    throw CommunicationException{};
+		    //a full pipe already wakes the progress thread, so neither end blocks
+		    for (const int fd : wake_pipe)
+			fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+		    progress_thread = std::thread{[this](){ progress();}};
+		}
+		//! Transports can not be copied
+		Socket_transport (const Socket_transport&) = delete;
+		//! Transports can not be copied
+		Socket_transport& operator= (const Socket_transport&) = delete;
+		/**
+		 * @brief Destructor for the Socket_transport class
+		 *
+		 * Write the queued messages, then close the sockets.
+		 */
+		~Socket_transport(){
+
+		    {
+			std::lock_guard<std::mutex> lock{queues_mutex};
+			stopping = true;
+		    }
+		    wake();
+		    progress_thread.join();
+		    for (const int fd : sockets)
+			if (fd >= 0)
+			    close(fd);
+		    close(wake_pipe[0]);
+		    close(wake_pipe[1]);
+		}
+
+		size_t get_rank() const noexcept override { return rank;}
+		size_t get_size() const noexcept override { return sockets.size();}
+
+	    protected:
+
+		void deliver (const size_t destination, const void* data, const size_t bytes) override {
+
+		    const std::uint64_t header = bytes;
+		    {
+			std::lock_guard<std::mutex> lock{queues_mutex};
+			Byte_queue& queue = destination == rank ? incoming[rank] : outgoing[destination];
+			queue.append(&header, sizeof(header));
+			queue.append(data, bytes);
+		    }
+		    if (destination == rank)
+			data_arrived.notify_all();
+		    else
+			wake();
+		}
+		void collect (const size_t source, void* data, const size_t bytes) override {
+
+		    std::unique_lock<std::mutex> lock{queues_mutex};
+		    Byte_queue& queue = incoming[source];
+		    std::uint64_t header = 0;
+		    auto complete = [&](){
+			if (queue.size() < sizeof(header))
+			    return false;
+			std::memcpy(&header, queue.front(), sizeof(header));
+			return queue.size() >= sizeof(header) + header;
+		    };
+		    data_arrived.wait(lock, [&](){ return complete() || closed[source];});
+		    if (!complete())
+			throw CommunicationException{};
+		    //a message of another size is discarded
+		    if (header != bytes){
+
+			queue.pop(sizeof(header) + header);
+			throw CommunicationException{};
+		    }
+		    if (bytes)
+			std::memcpy(data, queue.front() + sizeof(header), bytes);
+		    queue.pop(sizeof(header) + bytes);
+		}
+
+	    private:
+
+		/**
+		 * Wake the progress thread
+		 */
+		void wake (){
+
+		    const char token = 0;
+		    while (write(wake_pipe[1], &token, 1) < 0 && errno == EINTR);
+		}
+		/**
+		 * Body of the progress thread: move data between the sockets and the queues until
+		 * the transport stops and every queued message has been written
+		 */
+		void progress (){
+
+		    std::vector<char> buffer(size_t{1} << 16);
+		    std::vector<pollfd> polled;
+		    std::vector<size_t> peers;
+		    for (;;){
+
+			polled.assign(1, pollfd{wake_pipe[0], POLLIN, 0});
+			peers.assign(1, rank);
+			{
+			    std::lock_guard<std::mutex> lock{queues_mutex};
+			    bool pending = false;
+			    for (size_t peer = 0; peer < sockets.size(); ++peer){
+
+				if (sockets[peer] < 0 || closed[peer])
+				    continue;
+				const bool has_output = outgoing[peer].size() > 0;
+				pending |= has_output;
+				polled.push_back(pollfd{sockets[peer], static_cast<short>(POLLIN | (has_output ? POLLOUT : 0)), 0});
+				peers.push_back(peer);
+			    }
+			    if (stopping && !pending)
+				return;
+			}
+			if (poll(polled.data(), polled.size(), -1) < 0){
+
+			    if (errno == EINTR)
+				continue;
+			    //no socket can progress any more: the waiting receivers throw instead of blocking forever
+			    {
+				std::lock_guard<std::mutex> lock{queues_mutex};
+				for (size_t peer = 0; peer < sockets.size(); ++peer)
+				    if (sockets[peer] >= 0)
+					closed[peer] = true;
+			    }
+			    data_arrived.notify_all();
+			    return;
+			}
+
+			if (polled[0].revents & POLLIN)
+			    while (read(wake_pipe[0], buffer.data(), buffer.size()) > 0);
+			bool arrived = false;
+			for (size_t k = 1; k < polled.size(); ++k){
+
+			    const size_t peer = peers[k];
+			    const int fd = polled[k].fd;
+			    if (polled[k].revents & (POLLIN | POLLHUP | POLLERR)){
+
+				for (;;){
+
+				    const ssize_t n = read(fd, buffer.data(), buffer.size());
+				    if (n > 0){
+
+					std::lock_guard<std::mutex> lock{queues_mutex};
+					incoming[peer].append(buffer.data(), n);
+					arrived = true;
+				    }
+				    else if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)){
+
+					std::lock_guard<std::mutex> lock{queues_mutex};
+					closed[peer] = true;
+					arrived = true;
+					break;
+				    }
+				    else if (errno != EINTR)
+					break;
+				}
+			    }
+			    if (polled[k].revents & POLLOUT){
+
+				std::lock_guard<std::mutex> lock{queues_mutex};
+				Byte_queue& queue = outgoing[peer];
+				while (queue.size() > 0){
+
+				    const ssize_t n = ::send(fd, queue.front(), queue.size(), MSG_NOSIGNAL);
+				    if (n > 0)
+					queue.pop(n);
+				    else{
+
+					if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+					    closed[peer] = true;
+					if (errno != EINTR)
+					    break;
+				    }
+				}
+			    }
+			}
+			if (arrived)
+			    data_arrived.notify_all();
+		    }
+		}
+	};
+
+	    /**
+	     * @brief Run a function in n local processes connected by a Socket_transport
+	     *
+	     * Every pair of processes is connected by a Unix domain socket pair, then n child processes
+	     * are forked and call body with their transport. The calling process waits for all of them.
+	     * It should not be running other threads, which are not copied in the children, apart from the
+	     * idle workers of parallel_pool(): the children create their own.
+	     *
+	     * @param n_processes Number of processes
+	     * Buffered output is flushed before forking, so that the children do not repeat it, and before the
+	     * children exit, since _exit discards it.
+	     *
+	     * @param body Function run by every process, an exception makes the process fail
+	     * @returns True if every process completed body without exceptions
+	     *
+	     * @throws CommunicationException if the sockets or the processes can not be created.
+	     */
+	    inline bool launch_processes (const size_t n_processes, const std::function<void(Transport&)>& body){
+
+		//sockets[i][j] is the end of the pair (i, j) used by process i
+		std::vector<std::vector<int>> sockets(n_processes, std::vector<int>(n_processes, -1));
+		auto close_all = [&sockets](){
+		    for (auto& row : sockets)
+			for (int& fd : row)
+			    if (fd >= 0){
+
+				close(fd);
+				fd = -1;
+			    }
+		};
+		for (size_t i = 0; i < n_processes; ++i)
+		    for (size_t j = i + 1; j < n_processes; ++j){
+
+			int pair[2];
+			if (socketpair(AF_UNIX, SOCK_STREAM, 0, pair) != 0){
+
+			    close_all();
+			    throw CommunicationException{};
+			}
+			sockets[i][j] = pair[0];
+			sockets[j][i] = pair[1];
+		    }
+
+		std::cout.flush();
+		std::cerr.flush();
+		std::fflush(nullptr);
+		std::vector<pid_t> children;
+		for (size_t rank = 0; rank < n_processes; ++rank){
+
+		    const pid_t pid = fork();
+		    if (pid == 0){
+
+			detail::reset_parallel_pool_after_fork();
+			//keep the ends of this process only
+			for (size_t i = 0; i < n_processes; ++i)
+			    if (i != rank)
+				for (const int fd : sockets[i])
+				    if (fd >= 0)
+					close(fd);
+			int status = 0;
+			try{
+			    Socket_transport transport{rank, sockets[rank]};
+			    body(transport);
+			}
+			catch (...){
+			    status = 1;
+			}
+			std::cout.flush();
+			std::cerr.flush();
+			std::fflush(nullptr);
+			_exit(status);
+		    }
+		    if (pid < 0)
+			break;
+		    children.push_back(pid);
+		}
+		close_all();
+
+		bool success = children.size() == n_processes;
+		for (const pid_t child : children){
+
+		    int status = 0;
+		    while (waitpid(child, &status, 0) < 0 && errno == EINTR);
+		    success &= WIFEXITED(status) && WEXITSTATUS(status) == 0;
+		}
+		if (children.size() != n_processes)
+		    throw CommunicationException{};
+		return success;
+	    }
+    }
+}
+
+#endif
@@ -0,0 +1,337 @@
+//: marsh/Vector.hpp
+/**
+ * @file marsh/Vector.hpp
+ */
+
+#ifndef MARSH_VECTOR_HPP
+#define MARSH_VECTOR_HPP
+
+/*
+ * Include headers
+ */
+#include <memory>
+#include <utility>
+#include <iostream>
+
+#include "../leaq_exceptions.hpp"
+
+namespace leaqx8664{
+
+    namespace marsh{
+
+	/////////////////////
+	// VECTOR VIEW CLASS
+	/////////////////////
+
+	/**
+	 * @class Vector_view
+	 *
+	 * @brief Non owning view on equally spaced elements
+	 *
+	 * A Vector_view refers to size elements in memory, each stride positions after the previous one.
+	 * Rows and columns of a Matrix are exposed as Vector_view objects, so that they can be passed to the
+	 * same kernels that work on Vector objects. Use Vector_view<const T> for read only views.
+	 */
+	template <typename T>
+	class Vector_view{
+
+	    public:
+
+		//! Alias for scalar_type used in the view
+		using scalar_type = T;
+
+	    private:
+
+		//! Pointer to the first element of the view
+		scalar_type* first;
+		//! Number of elements in the view
+		size_t view_size;
+		//! Distance between consecutive elements of the view
+		size_t view_stride;
+
+	    public:
+
+		/**
+		 * Create a view on n_elements starting at target and spaced by stride
+		 *
+		 * @param target First element of the view
+		 * @param n_elements Number of elements in the view
+		 * @param stride Distance between consecutive elements
+		 */
+		Vector_view (scalar_type* target, const size_t n_elements, const size_t stride = 1) noexcept :
+		    first{target}, view_size{n_elements}, view_stride{stride}
+		{}
+		/**
+		 * @brief Overloading of operator() for the Vector_view class
+		 *
+		 * Return a reference to the element in the given position. Indexing starts at 0.
+		 *
+		 * @param index The index of the desired element.
+		 * @returns A reference to the element in position index inside the view.
+		 *
+		 * @throws IndexOutOfBoundsException if the given index is not valid.
+		 */
+		scalar_type& operator()(const size_t index) const {
+
+		    if (index < view_size)
+			return first[index*view_stride];
+		    throw IndexOutOfBoundsException{};
+		}
+		/**
+		 * @brief Get the number of elements in the view
+		 *
+		 * @returns The size of the view
+		 */
+		size_t get_size() const noexcept { return view_size;}
+		/**
+		 * @brief Get the distance between consecutive elements of the view
+		 *
+		 * @returns The stride of the view
+		 */
+		size_t get_stride() const noexcept { return view_stride;}
+		/**
+		 * @brief Get a pointer to the first element of the view
+		 *
+		 * @returns A pointer to the first element
+		 */
+		scalar_type* data() const noexcept { return first;}
+	};
+
+	/////////////////////
+	// VECTOR CLASS
+	/////////////////////
+
+	/**
+	 * @class Vector
+	 *
+	 * @brief Class representing a vector of scalars
+	 *
+	 * A vector is a 1 dimensional array of contiguous scalar elements. Kernels operating on vectors
+	 * are declared in marsh/Blas.hpp.
+	 */
+	template <typename T>
+	class Vector{
+
+	    public:
+
+		//! Alias for scalar_type used in the vector
+		using scalar_type = T;
+		//! Alias for vector iterators
+		using iterator = scalar_type*;
+		//! Alias for vector const iterators
+		using const_iterator = const scalar_type*;
+
+	    private:
+
+		////////////////////////////////
+		// DATA MEMBERS DECLARATIONS
+		////////////////////////////////
+		    //! Pointer to array of elements in the vector
+		    std::unique_ptr<scalar_type[]> elements;
+		    //! Number of elements in the vector
+		    size_t vector_size;
+
+	    public:
+
+		///////////////////
+		// VECTOR CLASS CONSTRUCTORS
+		///////////////////
+		    /**
+		     * Create a vector of n_elements uninitialized values
+		     *
+		     * @param n_elements Number of elements in the vector
+		     */
+		    explicit Vector (const size_t n_elements) :
+			elements{new T[n_elements]}, vector_size{n_elements}
+		    {}
+		    /**
+		     * Create a vector with a copy of the elements in the given view
+		     *
+		     * @param view The elements to copy
+		     */
+		    template <typename U>
+		    explicit Vector (const Vector_view<U>& view) :
+			Vector(view.get_size())
+		    {
+			for (size_t i = 0; i < vector_size; ++i)
+			    elements[i] = view.data()[i*view.get_stride()];
+		    }
+		    /**
+		     * Copy constructor for Vector objects
+		     *
+		     * @param other Vector object to copy from
+		     */
+		    Vector (const Vector& other) :
+			elements{new T[other.vector_size]}, vector_size{other.vector_size}
+		    {
+			for (size_t i = 0; i < vector_size; ++i)
+			    elements[i] = other.elements[i];
+		    }
+		    /**
+		     * Move constructor for Vector objects
+		     *
+		     * @param other Vector object to move from
+		     */
+		    Vector (Vector&& other) :
+			elements{other.elements.release()}, vector_size{other.vector_size}
+		    {}
+
+		///////////////////
+		// VECTOR DESTRUCTOR
+		///////////////////
+		    /**
+		     * @brief Destructor for the Vector class
+		     *
+		     * The destructor is set to the default one.
+		     */
+		    ~Vector() = default;
+
+		///////////////////
+		// OPERATORS OVERLOADING
+		///////////////////
+		    /*
+		     * @brief Overloading of operator= to allow copy assignment.
+		     *
+		     * @param other The vector to copy from
+		     */
+		    Vector& operator= (const Vector& other){
+
+			elements.reset(new T[other.vector_size]);
+			vector_size = other.vector_size;
+			for (size_t i = 0; i < vector_size; ++i)
+			    elements[i] = other.elements[i];
+			return *this;
+		    }
+		    /*
+		     * @brief Overloading of operator= to allow move assignment.
+		     *
+		     * @param other An rvalue reference to a vector to move from.
+		     */
+		    Vector& operator= (Vector&& other){
+
+			elements = std::move(other.elements);
+			vector_size = other.vector_size;
+			return *this;
+		    }
+		    /**
+		     * @brief Overloading of operator() for the Vector class
+		     *
+		     * Return a reference to the element in the given position. Indexing starts at 0.
+		     *
+		     * @param index The index of the desired element.
+		     * @returns A reference to the element in position index inside the vector.
+		     *
+		     * @throws IndexOutOfBoundsException if the given index is not valid.
+		     */
+		    scalar_type& operator()(const size_t index){
+
+			if (index < vector_size)
+			    return elements[index];
+			throw IndexOutOfBoundsException{};
+		    }
+		    /**
+		     * @brief Overloading of operator() for the Vector class
+		     *
+		     * Return a const reference to the element in the given position. Indexing starts at 0.
+		     *
+		     * @param index The index of the desired element.
+		     * @returns A const reference to the element in position index inside the vector.
+		     *
+		     * @throws IndexOutOfBoundsException if the given index is not valid.
+		     */
+		    const scalar_type& operator()(const size_t index) const {
+
+			if (index < vector_size)
+			    return elements[index];
+			throw IndexOutOfBoundsException{};
+		    }
+		    /**
+		     * @brief Overloading of operator== for Vector class
+		     *
+		     * @param other The vector to compare with this one.
+		     * @returns True if the vectors have the same size and elements, false otherwise.
+		     */
+		    bool operator== (const Vector& other) const noexcept {
+
+			if (vector_size != other.vector_size)
+			    return false;
+			for (size_t i = 0; i < vector_size; ++i)
+			    if (elements[i] != other.elements[i])
+				return false;
+			return true;
+		    }
+		    /**
+		     * @brief Overloading of operator!= for Vector class
+		     *
+		     * @param other The vector to compare with this one.
+		     * @returns True if the vectors have different size or elements, false otherwise.
+		     */
+		    bool operator!= (const Vector& other) const noexcept {
+
+			return !operator==(other);
+		    }
+
+		///////////////////
+		// BEGIN AND END FUNCTIONS
+		///////////////////
+		    //! Get an iterator to the first element of the vector
+		    iterator begin() noexcept { return elements.get();}
+		    //! Get an iterator past the last element of the vector
+		    iterator end() noexcept { return elements.get() + vector_size;}
+		    //! Get a const iterator to the first element of the vector
+		    const_iterator begin() const noexcept { return elements.get();}
+		    //! Get a const iterator past the last element of the vector
+		    const_iterator end() const noexcept { return elements.get() + vector_size;}
+
+		///////////////////
+		// SIZE AND STORAGE MEMBERS
+		///////////////////
+		    /**
+		     * @brief Get the number of elements in the vector
+		     *
+		     * @returns The size of the vector
+		     */
+		    size_t get_size() const noexcept { return vector_size;}
+		    /**
+		     * @brief Get the distance between consecutive elements of the vector
+		     *
+		     * Vectors are contiguous, this member allows kernels to treat vectors and
+		     * views in the same way.
+		     *
+		     * @returns 1
+		     */
+		    size_t get_stride() const noexcept { return 1;}
+		    //! Get a pointer to the elements of the vector
+		    scalar_type* data() noexcept { return elements.get();}
+		    //! Get a const pointer to the elements of the vector
+		    const scalar_type* data() const noexcept { return elements.get();}
+		    //! Get a view on the whole vector
+		    Vector_view<scalar_type> view() noexcept { return Vector_view<scalar_type>{elements.get(), vector_size};}
+		    //! Get a read only view on the whole vector
+		    Vector_view<const scalar_type> view() const noexcept { return Vector_view<const scalar_type>{elements.get(), vector_size};}
+	};
+
+	////////////////
+	// OPERATOR PUT TO FOR THE VECTOR CLASS
+	////////////////
+	    /**
+	     * @brief Overloading of operator<< for Vector class
+	     *
+	     * The given Vector is redirected to the given std::ostream between square brackets.
+	     *
+	     * @param os The target std::ostream
+	     * @param vector The Vector object to redirect
+	     */
+	    template <typename T>
+	    std::ostream& operator<< (std::ostream& os, const Vector<T>& vector){
+
+		os << "[ ";
+		for (const auto& x : vector)
+		    os << x << " ";
+		os << "]";
+		return os;
+	    }
+    }
+}
+
+#endif
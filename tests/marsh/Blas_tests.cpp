@@ -0,0 +1,311 @@
+//: tests/marsh/Blas_tests.cpp
+
+#include "leaqx8664.hpp"
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using leaqx8664::marsh::Transpose;
+using leaqx8664::marsh::Triangle;
+using leaqx8664::marsh::Diagonal;
+
+/////////////////////
+// PARALLEL TESTS
+/////////////////////
+    ////////////////////
+    // Test that parallel_for runs every chunk once, also when nested or
+    // when the number of threads changes concurrently, and that it
+    // propagates exceptions thrown by any chunk
+    ////////////////////
+    bool test_parallel_for();
+
+/////////////////////
+// LEVEL 1 TESTS
+/////////////////////
+    ////////////////////
+    // Test dot on contiguous vectors long enough to be split among
+    // threads and on strided views
+    ////////////////////
+    bool test_dot();
+    ////////////////////
+    // Test nrm2 on vectors whose squares would overflow
+    ////////////////////
+    bool test_nrm2();
+    ////////////////////
+    // Test axpy and scal on vectors and views
+    ////////////////////
+    bool test_axpy_scal();
+
+/////////////////////
+// LEVEL 2 TESTS
+/////////////////////
+    ////////////////////
+    // Test gemv with and without transposition for every layout
+    ////////////////////
+    bool test_gemv();
+    ////////////////////
+    // Test ger for every layout
+    ////////////////////
+    bool test_ger();
+    ////////////////////
+    // Test trsv for both triangles, with and without transposition
+    ////////////////////
+    bool test_trsv();
+
+
+int main(){
+
+    leaqx8664::marsh::set_num_threads(4);
+    std::cerr << std::setw(50) << std::left << "Parallel for test : " << (test_parallel_for() ? "passed" : "failed") << std::endl;
+    std::cerr << std::setw(50) << std::left << "Dot test : " << (test_dot() ? "passed" : "failed") << std::endl;
+    std::cerr << std::setw(50) << std::left << "Nrm2 test : " << (test_nrm2() ? "passed" : "failed") << std::endl;
+    std::cerr << std::setw(50) << std::left << "Axpy and scal test : " << (test_axpy_scal() ? "passed" : "failed") << std::endl;
+    std::cerr << std::setw(50) << std::left << "Gemv test : " << (test_gemv() ? "passed" : "failed") << std::endl;
+    std::cerr << std::setw(50) << std::left << "Ger test : " << (test_ger() ? "passed" : "failed") << std::endl;
+    std::cerr << std::setw(50) << std::left << "Trsv test : " << (test_trsv() ? "passed" : "failed") << std::endl;
+}
+
+/////////////////////
+// PARALLEL TESTS
+/////////////////////
+    bool test_parallel_for(){
+
+	//every index visited once, with nested calls inside the chunks
+	std::vector<std::atomic<int>> visits(1000);
+	leaqx8664::marsh::parallel_for(0, 100, 1, [&visits](size_t, size_t b, size_t e){
+	    for (size_t i = b; i < e; ++i)
+		leaqx8664::marsh::parallel_for(10*i, 10*i + 10, 2, [&visits](size_t, size_t nb, size_t ne){
+		    for (size_t j = nb; j < ne; ++j)
+			++visits[j];
+		});
+	});
+	bool result = true;
+	for (const auto& count : visits)
+	    result &= (count == 1);
+
+	//exceptions from the first chunk, which runs on the caller, and from the last one
+	for (const size_t failing : {size_t{0}, size_t{3}}){
+
+	    std::atomic<size_t> completed{0};
+	    try{
+		leaqx8664::marsh::parallel_for(0, 4, 1, [&completed, failing](size_t chunk, size_t, size_t){
+		    if (chunk == failing)
+			throw std::runtime_error{"chunk failed"};
+		    ++completed;
+		});
+		result = false;
+	    }
+	    catch (std::runtime_error&){}
+	    result &= (completed == 3);
+	}
+
+	//the number of threads changed while kernels run, reductions long enough for 16 chunks
+	leaqx8664::marsh::Vector<double> ones{size_t{1} << 19};
+	for (auto& value : ones)
+	    value = 1;
+	std::atomic<bool> done{false};
+	std::thread setter{[&done](){
+	    for (size_t n = 1; !done; n = n % 16 + 1)
+		leaqx8664::marsh::set_num_threads(n);
+	}};
+	for (size_t round = 0; round < 200; ++round){
+
+	    result &= leaqx8664::marsh::dot(ones, ones) == ones.get_size();
+	    result &= std::abs(leaqx8664::marsh::nrm2(ones) - std::sqrt(ones.get_size())) < 1e-9;
+
+	    std::atomic<size_t> sum{0};
+	    leaqx8664::marsh::parallel_for(0, 1000, 1, [&sum](size_t, size_t b, size_t e){
+		for (size_t i = b; i < e; ++i)
+		    sum += i;
+	    });
+	    result &= (sum == 999*1000/2);
+	}
+	done = true;
+	setter.join();
+	leaqx8664::marsh::set_num_threads(4);
+	return result;
+    }
+
+/////////////////////
+// LEVEL 1 TESTS
+/////////////////////
+    bool test_dot(){
+
+	const size_t n = 200003;
+	leaqx8664::marsh::Vector<long> x{n}, y{n};
+	long expected = 0;
+	for (size_t i = 0; i < n; ++i){
+
+	    x(i) = i % 7;
+	    y(i) = i % 5;
+	    expected += x(i)*y(i);
+	}
+	bool result = (leaqx8664::marsh::dot(x, y) == expected);
+
+	leaqx8664::marsh::Matrix<long> mat{4,4};
+	for (size_t i = 0; i <= mat.get_max_index(); ++i)
+	    mat(i) = i;
+	result &= (leaqx8664::marsh::dot(mat.row(1), mat.column(2)) == 4*2 + 5*6 + 6*10 + 7*14);
+	return result;
+    }
+    bool test_nrm2(){
+
+	leaqx8664::marsh::Vector<double> x{100000};
+	for (auto& value : x)
+	    value = 3e200;
+	double norm = leaqx8664::marsh::nrm2(x);
+	return std::abs(norm - 3e200*std::sqrt(100000.0)) < 1e-12*norm;
+    }
+    bool test_axpy_scal(){
+
+	leaqx8664::marsh::Vector<double> x{70000}, y{70000};
+	for (size_t i = 0; i < 70000; ++i){
+
+	    x(i) = i;
+	    y(i) = 1;
+	}
+	leaqx8664::marsh::axpy(2, x, y);
+	leaqx8664::marsh::scal(0.5, y);
+	bool result = true;
+	for (size_t i = 0; i < 70000; ++i)
+	    result &= (y(i) == i + 0.5);
+
+	leaqx8664::marsh::Matrix<double> mat{3,3};
+	for (size_t i = 0; i <= mat.get_max_index(); ++i)
+	    mat(i) = i;
+	leaqx8664::marsh::axpy(-1, mat.column(0), mat.column(2));
+	result &= (mat(0,2) == 2) && (mat(1,2) == 2) && (mat(2,2) == 2);
+	return result;
+    }
+
+/////////////////////
+// LEVEL 2 TESTS
+/////////////////////
+    template <typename L>
+    bool check_gemv(size_t m, size_t n, Transpose trans){
+
+	leaqx8664::marsh::Matrix<long, L> a{m,n};
+	for (size_t i = 0; i < m; ++i)
+	    for (size_t j = 0; j < n; ++j)
+		a(i,j) = (i*3 + j*7) % 10;
+
+	const bool transposed = trans == Transpose::transpose;
+	const size_t rows = transposed ? n : m, columns = transposed ? m : n;
+	leaqx8664::marsh::Vector<long> x{columns}, y{rows};
+	for (size_t j = 0; j < columns; ++j)
+	    x(j) = j % 3;
+	for (size_t i = 0; i < rows; ++i)
+	    y(i) = 1;
+
+	leaqx8664::marsh::gemv(trans, 2, a, x, 3, y);
+	for (size_t i = 0; i < rows; ++i){
+
+	    long expected = 3;
+	    for (size_t j = 0; j < columns; ++j)
+		expected += 2*(transposed ? a(j,i) : a(i,j))*x(j);
+	    if (y(i) != expected)
+		return false;
+	}
+	return true;
+    }
+    template <typename L>
+    bool check_gemv_layout(){
+
+	return check_gemv<L>(301, 257, Transpose::no_transpose) && check_gemv<L>(301, 257, Transpose::transpose)
+	    && check_gemv<L>(7, 5, Transpose::no_transpose) && check_gemv<L>(7, 5, Transpose::transpose);
+    }
+    bool test_gemv(){
+
+	bool result = check_gemv_layout<leaqx8664::marsh::Row_major>() && check_gemv_layout<leaqx8664::marsh::Column_major>()
+	    && check_gemv_layout<leaqx8664::marsh::Tiled<16>>() && check_gemv_layout<leaqx8664::marsh::Morton>();
+
+	leaqx8664::marsh::Matrix<long> a{3,4};
+	leaqx8664::marsh::Vector<long> x{3}, y{3};
+	try{
+	    leaqx8664::marsh::gemv(Transpose::no_transpose, 1, a, x, 0, y);
+	    result = false;
+	}
+	catch (ShapeMismatchException&){}
+	return result;
+    }
+    template <typename L>
+    bool check_ger(){
+
+	leaqx8664::marsh::Matrix<long, L> a{33,17};
+	leaqx8664::marsh::Vector<long> x{33}, y{17};
+	for (size_t i = 0; i < 33; ++i){
+
+	    x(i) = i;
+	    for (size_t j = 0; j < 17; ++j)
+		a(i,j) = 1;
+	}
+	for (size_t j = 0; j < 17; ++j)
+	    y(j) = j;
+
+	leaqx8664::marsh::ger(2, x, y, a);
+	for (size_t i = 0; i < 33; ++i)
+	    for (size_t j = 0; j < 17; ++j)
+		if (a(i,j) != long(1 + 2*i*j))
+		    return false;
+	return true;
+    }
+    bool test_ger(){
+
+	return check_ger<leaqx8664::marsh::Row_major>() && check_ger<leaqx8664::marsh::Column_major>()
+	    && check_ger<leaqx8664::marsh::Morton>();
+    }
+    template <typename L>
+    bool check_trsv(Triangle uplo, Transpose trans, Diagonal diag){
+
+	const size_t n = 40;
+	leaqx8664::marsh::Matrix<double, L> a{n,n};
+	for (size_t i = 0; i < n; ++i)
+	    for (size_t j = 0; j < n; ++j){
+
+		const bool stored = uplo == Triangle::lower ? j <= i : j >= i;
+		//values outside the triangle must be ignored
+		a(i,j) = stored ? (i == j ? 4.0 + i % 3 : 0.1*((i + 2*j) % 5)) : 1e10;
+	    }
+
+	leaqx8664::marsh::Vector<double> solution{n}, x{n};
+	for (size_t i = 0; i < n; ++i)
+	    solution(i) = 1.0 + i % 4;
+	//x = op(a)*solution
+	const bool transposed = trans == Transpose::transpose;
+	for (size_t i = 0; i < n; ++i){
+
+	    x(i) = 0;
+	    for (size_t k = 0; k < n; ++k){
+
+		const size_t r = transposed ? k : i, c = transposed ? i : k;
+		const bool stored = uplo == Triangle::lower ? c <= r : c >= r;
+		if (stored)
+		    x(i) += (r == c && diag == Diagonal::unit ? 1.0 : a(r,c))*solution(k);
+	    }
+	}
+
+	leaqx8664::marsh::trsv(uplo, trans, diag, a, x);
+	for (size_t i = 0; i < n; ++i)
+	    if (std::abs(x(i) - solution(i)) > 1e-10)
+		return false;
+	return true;
+    }
+    template <typename L>
+    bool check_trsv_layout(){
+
+	bool result = true;
+	for (auto uplo : {Triangle::lower, Triangle::upper})
+	    for (auto trans : {Transpose::no_transpose, Transpose::transpose})
+		for (auto diag : {Diagonal::non_unit, Diagonal::unit})
+		    result &= check_trsv<L>(uplo, trans, diag);
+	return result;
+    }
+    bool test_trsv(){
+
+	return check_trsv_layout<leaqx8664::marsh::Row_major>() && check_trsv_layout<leaqx8664::marsh::Column_major>()
+	    && check_trsv_layout<leaqx8664::marsh::Tiled<8>>();
+    }
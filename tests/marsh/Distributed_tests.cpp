@@ -0,0 +1,248 @@
+//: tests/marsh/Distributed_tests.cpp
+
+#include "leaqx8664.hpp"
+#include "Test_helpers.hpp"
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+using leaqx8664::marsh::Matrix;
+using leaqx8664::marsh::Distributed_matrix;
+using leaqx8664::marsh::Process_grid;
+using leaqx8664::marsh::Transport;
+
+/////////////////////
+// TRANSPORT TESTS
+/////////////////////
+    ////////////////////
+    // Test messages around a ring of processes, messages to self,
+    // size mismatches, failing processes and output of the processes
+    ////////////////////
+    bool test_socket_transport();
+
+/////////////////////
+// DISTRIBUTION TESTS
+/////////////////////
+    ////////////////////
+    // Test block cyclic ownership, scatter and gather
+    ////////////////////
+    bool test_block_cyclic_distribution();
+
+/////////////////////
+// PRODUCT TESTS
+/////////////////////
+    ////////////////////
+    // Test SUMMA on rectangular grids against the local product
+    ////////////////////
+    bool test_summa();
+    ////////////////////
+    // Test Cannon's algorithm on square grids against the local product
+    ////////////////////
+    bool test_cannon();
+    ////////////////////
+    // Test the communication counters collected after a product
+    ////////////////////
+    bool test_communication_statistics();
+
+
+int main(){
+
+    leaqx8664::marsh::set_num_threads(2);
+    std::cerr << std::setw(50) << std::left << "Socket transport test : " << (test_socket_transport() ? "passed" : "failed") << std::endl;
+    std::cerr << std::setw(50) << std::left << "Block cyclic distribution test : " << (test_block_cyclic_distribution() ? "passed" : "failed") << std::endl;
+    std::cerr << std::setw(50) << std::left << "SUMMA test : " << (test_summa() ? "passed" : "failed") << std::endl;
+    std::cerr << std::setw(50) << std::left << "Cannon test : " << (test_cannon() ? "passed" : "failed") << std::endl;
+    std::cerr << std::setw(50) << std::left << "Communication statistics test : " << (test_communication_statistics() ? "passed" : "failed") << std::endl;
+}
+
+    //processes report failures through their exit status
+    void require(bool condition){
+
+	if (!condition)
+	    throw ShapeMismatchException{};
+    }
+    //multiply with the given algorithm on a grid and compare with the local product on rank 0
+    template <typename F>
+    bool check_product(F algorithm, Process_grid grid, size_t m, size_t k, size_t n, size_t mb, size_t kb, size_t nb){
+
+	return leaqx8664::marsh::launch_processes(grid.rows*grid.columns, [=](Transport& transport){
+	    const Matrix<double> a = test_matrix(m, k, 0.0), b = test_matrix(k, n, 1.0);
+	    Distributed_matrix<double> da{transport, grid, m, k, mb, kb}, db{transport, grid, k, n, kb, nb}, dc{transport, grid, m, n, mb, nb};
+	    da.distribute(a);
+	    db.distribute(b);
+	    algorithm(da, db, dc);
+	    Matrix<double> c{m, n};
+	    dc.gather(c);
+	    if (transport.get_rank() == 0)
+		require(close(c, a*b));
+	});
+    }
+
+/////////////////////
+// TRANSPORT TESTS
+/////////////////////
+    bool test_socket_transport(){
+
+	bool result = leaqx8664::marsh::launch_processes(5, [](Transport& transport){
+	    const size_t rank = transport.get_rank(), size = transport.get_size();
+	    require(size == 5);
+
+	    //large messages around the ring, all sent before being received
+	    std::vector<double> outgoing(100000, rank), incoming(100000);
+	    for (size_t round = 0; round < 3; ++round){
+
+		transport.send((rank + 1) % size, outgoing);
+		transport.receive((rank + size - 1) % size, incoming);
+		require(incoming[99999] == (rank + size - 1) % size);
+	    }
+	    int value = 7, copy = 0;
+	    transport.send(rank, &value, sizeof(value));
+	    transport.receive(rank, &copy, sizeof(copy));
+	    require(copy == 7);
+
+	    //a receive of the wrong size fails
+	    transport.send((rank + 1) % size, &value, sizeof(value));
+	    try{
+		transport.receive((rank + size - 1) % size, incoming);
+		require(false);
+	    }
+	    catch (CommunicationException&){}
+	    transport.barrier();
+	});
+
+	//a failing process is reported
+	result &= !leaqx8664::marsh::launch_processes(3, [](Transport& transport){
+	    require(transport.get_rank() != 1);
+	});
+
+	//output left in the buffers of the processes is written when they exit
+	int output[2];
+	if (pipe(output) != 0)
+	    return false;
+	const int saved_stdout = dup(STDOUT_FILENO);
+	dup2(output[1], STDOUT_FILENO);
+	close(output[1]);
+	result &= leaqx8664::marsh::launch_processes(3, [](Transport&){
+	    std::cout << 'a';
+	    std::printf("b");
+	});
+	dup2(saved_stdout, STDOUT_FILENO);
+	close(saved_stdout);
+	std::string written;
+	char buffer[64];
+	for (ssize_t n; (n = read(output[0], buffer, sizeof(buffer))) > 0;)
+	    written.append(buffer, n);
+	close(output[0]);
+	result &= written.size() == 6 && std::count(written.begin(), written.end(), 'a') == 3;
+	return result;
+    }
+
+/////////////////////
+// DISTRIBUTION TESTS
+/////////////////////
+    bool test_block_cyclic_distribution(){
+
+	return leaqx8664::marsh::launch_processes(6, [](Transport& transport){
+	    const Process_grid grid{2, 3};
+	    const Matrix<double> global = test_matrix(11, 17, 0.0);
+	    Distributed_matrix<double> distributed{transport, grid, 11, 17, 3, 2};
+
+	    //rows 0-2, 6-8 on grid row 0, columns 0-1, 6-7, 12-13 on grid column 0
+	    require(distributed.owner(7, 13) == 0 && distributed.owner(10, 2) == grid.rank_of(1, 1));
+	    const auto position = distributed.get_grid_position();
+	    require(distributed.get_local().get_shape().first == (position.first == 0 ? 6 : 5));
+	    require(distributed.get_local().get_shape().second == (position.second == 0 ? 6 : (position.second == 1 ? 6 : 5)));
+
+	    distributed.scatter(global, 2);
+	    for (size_t i = 0; i < distributed.get_local().get_shape().first; ++i)
+		for (size_t j = 0; j < distributed.get_local().get_shape().second; ++j){
+
+		    require(distributed.owner(distributed.global_row(i), distributed.global_column(j)) == transport.get_rank());
+		    require(distributed.get_local()(i, j) == global(distributed.global_row(i), distributed.global_column(j)));
+		}
+
+	    Matrix<double> gathered{11, 17};
+	    distributed.gather(gathered, 4);
+	    if (transport.get_rank() == 4)
+		require(gathered == global);
+
+	    try{
+		Distributed_matrix<double> wrong{transport, Process_grid{2, 2}, 4, 4, 1, 1};
+		require(false);
+	    }
+	    catch (ShapeMismatchException&){}
+	});
+    }
+
+/////////////////////
+// PRODUCT TESTS
+/////////////////////
+    bool test_summa(){
+
+	auto summa = [](const Distributed_matrix<double>& a, const Distributed_matrix<double>& b, Distributed_matrix<double>& c){
+	    leaqx8664::marsh::summa(a, b, c);
+	};
+	bool result = check_product(summa, Process_grid{2, 3}, 37, 29, 41, 4, 5, 3);
+	result &= check_product(summa, Process_grid{3, 1}, 20, 50, 7, 2, 8, 2);
+	result &= check_product(summa, Process_grid{1, 1}, 9, 9, 9, 4, 4, 4);
+	//more processes than blocks in a dimension
+	result &= check_product(summa, Process_grid{2, 2}, 3, 40, 3, 4, 6, 4);
+	return result;
+    }
+    bool test_cannon(){
+
+	auto cannon = [](const Distributed_matrix<double>& a, const Distributed_matrix<double>& b, Distributed_matrix<double>& c){
+	    leaqx8664::marsh::cannon(a, b, c);
+	};
+	bool result = check_product(cannon, Process_grid{2, 2}, 32, 32, 32, 16, 16, 16);
+	result &= check_product(cannon, Process_grid{3, 3}, 37, 29, 41, 4, 5, 3);
+	result &= check_product(cannon, Process_grid{1, 1}, 9, 9, 9, 4, 4, 4);
+
+	//rectangular grids are rejected
+	result &= leaqx8664::marsh::launch_processes(2, [](Transport& transport){
+	    const Process_grid grid{1, 2};
+	    Distributed_matrix<double> a{transport, grid, 4, 4, 2, 2}, b{transport, grid, 4, 4, 2, 2}, c{transport, grid, 4, 4, 2, 2};
+	    try{
+		leaqx8664::marsh::cannon(a, b, c);
+		require(false);
+	    }
+	    catch (ShapeMismatchException&){}
+	});
+	return result;
+    }
+    bool test_communication_statistics(){
+
+	return leaqx8664::marsh::launch_processes(4, [](Transport& transport){
+	    const Process_grid grid{2, 2};
+	    const size_t n = 24;
+	    Distributed_matrix<double> a{transport, grid, n, n, 6, 6}, b{transport, grid, n, n, 6, 6}, c{transport, grid, n, n, 6, 6};
+	    a.distribute(test_matrix(n, n, 0.0));
+	    b.distribute(test_matrix(n, n, 1.0));
+	    transport.reset_statistics();
+	    leaqx8664::marsh::summa(a, b, c);
+
+	    //each process receives the panels of a and b it does not own: half of its block row and block column
+	    const auto own = transport.get_statistics();
+	    require(own.bytes_received == 2*(n/2)*(n/2)*sizeof(double) && own.messages_received == 4);
+	    const auto all = leaqx8664::marsh::gather_statistics(transport);
+	    if (transport.get_rank() == 0){
+
+		require(all.size() == 4);
+		std::uint64_t sent = 0, received = 0;
+		for (const auto& statistics : all){
+
+		    sent += statistics.bytes_sent;
+		    received += statistics.bytes_received;
+		    require(statistics.communication_time >= 0);
+		}
+		require(sent == received);
+	    }
+	    else
+		require(all.empty());
+	});
+    }
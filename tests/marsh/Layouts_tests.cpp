@@ -0,0 +1,71 @@
+//: tests/marsh/Layouts_tests.cpp
+
+#include "leaqx8664.hpp"
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <utility>
+
+/////////////////////
+// LAYOUT TESTS
+/////////////////////
+    /////////////////////
+    // Test that every position of a matrix with the given shape is mapped
+    // to a different offset inside the storage of the layout
+    /////////////////////
+    template <typename L>
+    bool test_offsets(size_t n_rows, size_t n_columns);
+    /////////////////////
+    // Test that sequential offsets agree with the offsets by row and column
+    /////////////////////
+    template <typename L>
+    bool test_sequential_offsets(size_t n_rows, size_t n_columns);
+    /////////////////////
+    // Test that aligned square blocks of a Morton layout are contiguous
+    /////////////////////
+    bool test_morton_blocks();
+
+
+int main(){
+
+    std::cerr << std::setw(50) << std::left << "Row major offsets test : " <<  (test_offsets<leaqx8664::marsh::Row_major>(13,7) ? "passed" : "failed") << std::endl;
+    std::cerr << std::setw(50) << std::left << "Column major offsets test : " <<  (test_offsets<leaqx8664::marsh::Column_major>(13,7) ? "passed" : "failed") << std::endl;
+    std::cerr << std::setw(50) << std::left << "Tiled offsets test : " <<  (test_offsets<leaqx8664::marsh::Tiled<4>>(13,7) ? "passed" : "failed") << std::endl;
+    std::cerr << std::setw(50) << std::left << "Morton offsets test : " <<  (test_offsets<leaqx8664::marsh::Morton>(13,7) && test_offsets<leaqx8664::marsh::Morton>(3,17) ? "passed" : "failed") << std::endl;
+    std::cerr << std::setw(50) << std::left << "Sequential offsets test : " <<  (test_sequential_offsets<leaqx8664::marsh::Column_major>(5,9) && test_sequential_offsets<leaqx8664::marsh::Tiled<4>>(5,9) && test_sequential_offsets<leaqx8664::marsh::Morton>(5,9) ? "passed" : "failed") << std::endl;
+    std::cerr << std::setw(50) << std::left << "Morton blocks test : " <<  (test_morton_blocks() ? "passed" : "failed") << std::endl;
+}
+
+    template <typename L>
+    bool test_offsets(size_t n_rows, size_t n_columns){
+
+	L layout{std::make_pair(n_rows, n_columns)};
+	std::vector<bool> used(layout.storage_size(), false);
+	for (size_t i = 0; i < n_rows; ++i)
+	    for (size_t j = 0; j < n_columns; ++j){
+
+		size_t offset = layout.offset(i,j);
+		if (offset >= used.size() || used[offset])
+		    return false;
+		used[offset] = true;
+	    }
+	return true;
+    }
+    template <typename L>
+    bool test_sequential_offsets(size_t n_rows, size_t n_columns){
+
+	L layout{std::make_pair(n_rows, n_columns)};
+	for (size_t i = 0; i < n_rows*n_columns; ++i)
+	    if (layout.offset(i) != layout.offset(i / n_columns, i % n_columns))
+		return false;
+	return true;
+    }
+    bool test_morton_blocks(){
+
+	leaqx8664::marsh::Morton layout{std::make_pair(size_t{16}, size_t{16})};
+	for (size_t i = 0; i < 4; ++i)
+	    for (size_t j = 0; j < 4; ++j)
+		if (layout.offset(4 + i, 8 + j) - layout.offset(4, 8) >= 16)
+		    return false;
+	return layout.offset(0,1) == 1 && layout.offset(1,0) == 2 && layout.offset(1,1) == 3;
+    }
@@ -46,6 +46,16 @@ std::array<int,8> test_2by4_matrix{1,2,3,4,5,6,7,8};
     //Test move and copy assignment 
     ////////////////////
     bool test_copy_move_assignment();
+    ////////////////////
+    // Test operator* for every combination of row major, column major,
+    // tiled and Morton operands against a naive product
+    ////////////////////
+    bool test_operator_multiply();
+    ////////////////////
+    // Test iteration and sequential access on matrices stored with
+    // non default layouts
+    ////////////////////
+    bool test_layout_access();
 
 /////////////////////
 // CONSTRUCTORS TESTS
@@ -58,6 +68,10 @@ std::array<int,8> test_2by4_matrix{1,2,3,4,5,6,7,8};
     //Test move constructor
     /////////////////////
     bool test_move_constructor();
+    /////////////////////
+    //Test conversion constructor between layouts
+    /////////////////////
+    bool test_layout_conversion();
 
 
 int main(){
@@ -72,6 +86,9 @@ int main(){
     std::cerr << std::setw(50) << std::left << "Copy constructor test : " << (test_copy_constructor() ? "passed" : "failed") << std::endl;
     std::cerr << std::setw(50) << std::left << "Move constructor test : " << (test_move_constructor() ? "passed" : "failed") << std::endl;
     std::cerr << std::setw(50) << std::left << "Copy and move assignment test : " << (test_copy_move_assignment() ? "passed" : "failed") << std::endl;
+    std::cerr << std::setw(50) << std::left << "Operator multiply test : " << (test_operator_multiply() ? "passed" : "failed") << std::endl;
+    std::cerr << std::setw(50) << std::left << "Layout access test : " << (test_layout_access() ? "passed" : "failed") << std::endl;
+    std::cerr << std::setw(50) << std::left << "Layout conversion test : " << (test_layout_conversion() ? "passed" : "failed") << std::endl;
 }
 
 /////////////////////
@@ -182,6 +199,75 @@ int main(){
 	result &= (mat2 == mat3);
 	return result;
     }
+    template <typename L1, typename L2>
+    bool check_multiply(size_t n, size_t m, size_t p){
+
+	leaqx8664::marsh::Matrix<long, L1> lhs{n,m};
+	leaqx8664::marsh::Matrix<long, L2> rhs{m,p};
+	for (size_t i = 0; i < n; ++i)
+	    for (size_t k = 0; k < m; ++k)
+		lhs(i,k) = (i*7 + k*3) % 11;
+	for (size_t k = 0; k < m; ++k)
+	    for (size_t j = 0; j < p; ++j)
+		rhs(k,j) = (k*5 + j) % 13;
+
+	leaqx8664::marsh::Matrix<long, L1> product = lhs*rhs;
+	for (size_t i = 0; i < n; ++i)
+	    for (size_t j = 0; j < p; ++j){
+
+		long expected = 0;
+		for (size_t k = 0; k < m; ++k)
+		    expected += lhs(i,k)*rhs(k,j);
+		if (product(i,j) != expected)
+		    return false;
+	    }
+	return true;
+    }
+    template <typename L>
+    bool check_multiply_with(size_t n, size_t m, size_t p){
+
+	return check_multiply<L, leaqx8664::marsh::Row_major>(n,m,p) && check_multiply<L, leaqx8664::marsh::Column_major>(n,m,p)
+	    && check_multiply<L, leaqx8664::marsh::Tiled<8>>(n,m,p) && check_multiply<L, leaqx8664::marsh::Morton>(n,m,p);
+    }
+    bool test_operator_multiply(){
+
+	bool result = check_multiply_with<leaqx8664::marsh::Row_major>(37,21,45)
+	    && check_multiply_with<leaqx8664::marsh::Column_major>(37,21,45)
+	    && check_multiply_with<leaqx8664::marsh::Tiled<8>>(37,21,45)
+	    && check_multiply_with<leaqx8664::marsh::Morton>(37,21,45);
+	//several leaves per dimension, and leaves that are not contiguous in thin Morton matrices
+	result &= check_multiply_with<leaqx8664::marsh::Tiled<8>>(70,40,66) && check_multiply_with<leaqx8664::marsh::Morton>(70,40,66)
+	    && check_multiply_with<leaqx8664::marsh::Morton>(3,70,5) && check_multiply_with<leaqx8664::marsh::Morton>(70,3,90);
+
+	leaqx8664::marsh::Matrix<int> mat{2,4};
+	try{
+	    mat*mat;
+	    result = false;
+	}
+	catch (ShapeMismatchException&){}
+	return result;
+    }
+    template <typename L>
+    bool check_layout_access(){
+
+	leaqx8664::marsh::Matrix<int, L> mat{2,4};
+	size_t i = 0;
+	for (auto& x : mat)
+	    x = test_2by4_matrix[i++];
+
+	bool result = true;
+	for (size_t j = 0; j <= mat.get_max_index(); ++j)
+	    result &= (mat(j) == test_2by4_matrix[j]);
+	for (size_t j = 0; j < 2; ++j)
+	    for (size_t k = 0; k < 4; ++k)
+		result &= (mat(j,k) == test_2by4_matrix[j*4 + k]);
+	return result;
+    }
+    bool test_layout_access(){
+
+	return check_layout_access<leaqx8664::marsh::Column_major>() && check_layout_access<leaqx8664::marsh::Tiled<3>>()
+	    && check_layout_access<leaqx8664::marsh::Morton>();
+    }
 /////////////////////
 // CONSTRUCTOR TESTS
 /////////////////////
@@ -211,3 +297,20 @@ int main(){
 	result &= (mat1(0) != mat2(0));
 	return result;
     }
+    bool test_layout_conversion(){
+
+	bool result = true;
+	leaqx8664::marsh::Matrix<int> mat{70,45};
+	for (size_t j = 0; j <= mat.get_max_index(); ++j)
+		mat(j) = j;
+
+	leaqx8664::marsh::Matrix<int, leaqx8664::marsh::Column_major> column_mat{mat};
+	leaqx8664::marsh::Matrix<int, leaqx8664::marsh::Tiled<16>> tiled_mat{column_mat};
+	leaqx8664::marsh::Matrix<int, leaqx8664::marsh::Morton> morton_mat{tiled_mat};
+	leaqx8664::marsh::Matrix<int> back{morton_mat};
+	result &= (column_mat == mat) && (tiled_mat == mat) && (morton_mat == mat) && (back == mat);
+	result &= (column_mat(69,44) == 69*45 + 44);
+	++(morton_mat(3,5));
+	result &= (morton_mat != mat);
+	return result;
+    }
@@ -0,0 +1,184 @@
+//: tests/marsh/Packed_tests.cpp
+
+#include "leaqx8664.hpp"
+#include "Test_helpers.hpp"
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+
+using leaqx8664::marsh::Transpose;
+using leaqx8664::marsh::Triangle;
+using leaqx8664::marsh::Diagonal;
+
+/////////////////////
+// STORAGE TESTS
+/////////////////////
+    ////////////////////
+    // Test element access and storage size of symmetric, triangular
+    // and banded matrices
+    ////////////////////
+    bool test_packed_access();
+
+/////////////////////
+// KERNEL TESTS
+/////////////////////
+    ////////////////////
+    // Test symm and syrk against products of the unpacked matrices
+    ////////////////////
+    bool test_symmetric_kernels();
+    ////////////////////
+    // Test trmm and trsm for both triangles
+    ////////////////////
+    bool test_triangular_kernels();
+    ////////////////////
+    // Test gbmv with and without transposition and gbsv
+    ////////////////////
+    bool test_banded_kernels();
+
+
+int main(){
+
+    leaqx8664::marsh::set_num_threads(4);
+    std::cerr << std::setw(50) << std::left << "Packed access test : " << (test_packed_access() ? "passed" : "failed") << std::endl;
+    std::cerr << std::setw(50) << std::left << "Symmetric kernels test : " << (test_symmetric_kernels() ? "passed" : "failed") << std::endl;
+    std::cerr << std::setw(50) << std::left << "Triangular kernels test : " << (test_triangular_kernels() ? "passed" : "failed") << std::endl;
+    std::cerr << std::setw(50) << std::left << "Banded kernels test : " << (test_banded_kernels() ? "passed" : "failed") << std::endl;
+}
+
+/////////////////////
+// STORAGE TESTS
+/////////////////////
+    bool test_packed_access(){
+
+	leaqx8664::marsh::Matrix<double> full = dominant_test_matrix(5,5);
+
+	leaqx8664::marsh::Packed_symmetric<double> symmetric{full};
+	bool result = symmetric.get_storage_size() == 15 && symmetric(1,3) == full(3,1) && symmetric(3,1) == full(3,1);
+	symmetric(0,4) = 42;
+	result &= symmetric(4,0) == 42;
+
+	leaqx8664::marsh::Packed_triangular<double> upper{full, Triangle::upper};
+	const auto& const_upper = upper;
+	result &= upper.get_storage_size() == 15 && upper(1,3) == full(1,3) && const_upper(3,1) == 0;
+	try{
+	    upper(3,1) = 1;
+	    result = false;
+	}
+	catch (IndexOutOfBoundsException&){}
+
+	leaqx8664::marsh::Banded<double> band{full, 1, 2};
+	const auto& const_band = band;
+	result &= band.get_storage_size() == 5*4 && band(2,1) == full(2,1) && band(2,4) == full(2,4) && const_band(3,0) == 0;
+	for (size_t i = 0; i < 5; ++i)
+	    for (size_t j = 0; j < 5; ++j)
+		result &= const_band(i*5 + j) == (j + 1 >= i && j <= i + 2 ? full(i,j) : 0.0);
+	try{
+	    band(4,0) = 1;
+	    result = false;
+	}
+	catch (IndexOutOfBoundsException&){}
+	return result;
+    }
+
+/////////////////////
+// KERNEL TESTS
+/////////////////////
+    bool test_symmetric_kernels(){
+
+	leaqx8664::marsh::Matrix<double> full = dominant_test_matrix(70,70);
+	leaqx8664::marsh::Packed_symmetric<double> a{full};
+	leaqx8664::marsh::Matrix<double> b = dominant_test_matrix(70,150);
+	leaqx8664::marsh::Matrix<double, leaqx8664::marsh::Column_major> c{dominant_test_matrix(70,150)};
+
+	leaqx8664::marsh::Matrix<double> expected = a.unpack()*b;
+	for (size_t i = 0; i <= expected.get_max_index(); ++i)
+	    expected(i) = 2*expected(i) + 0.5*c(i);
+	leaqx8664::marsh::symm(2, a, b, 0.5, c);
+	bool result = close(c, expected);
+
+	leaqx8664::marsh::Matrix<double> transposed{150,70};
+	for (size_t i = 0; i < 70; ++i)
+	    for (size_t j = 0; j < 150; ++j)
+		transposed(j,i) = b(i,j);
+	leaqx8664::marsh::Matrix<double> product = b*transposed;
+	leaqx8664::marsh::Packed_symmetric<double> gram{70};
+	leaqx8664::marsh::syrk(1, b, 0, gram);
+	result &= close(gram, product);
+
+	//odd order, the middle row is not paired
+	leaqx8664::marsh::Matrix<double> odd = dominant_test_matrix(71,20);
+	leaqx8664::marsh::Packed_symmetric<double> odd_gram{dominant_test_matrix(71,71)};
+	leaqx8664::marsh::Matrix<double> odd_expected = odd_gram.unpack();
+	for (size_t i = 0; i < 71; ++i)
+	    for (size_t j = 0; j < 71; ++j){
+
+		double dot = 0;
+		for (size_t k = 0; k < 20; ++k)
+		    dot += odd(i,k)*odd(j,k);
+		odd_expected(i,j) = 3*dot - odd_expected(i,j);
+	    }
+	leaqx8664::marsh::syrk(3, odd, -1, odd_gram);
+	result &= close(odd_gram, odd_expected);
+	return result;
+    }
+    bool check_triangular(Triangle uplo, Diagonal diag){
+
+	leaqx8664::marsh::Matrix<double> full = dominant_test_matrix(40,40);
+	leaqx8664::marsh::Packed_triangular<double> a{full, uplo};
+	leaqx8664::marsh::Matrix<double> unpacked = a.unpack();
+	if (diag == Diagonal::unit)
+	    for (size_t i = 0; i < 40; ++i)
+		unpacked(i,i) = 1;
+	leaqx8664::marsh::Matrix<double> b = dominant_test_matrix(40,130);
+
+	leaqx8664::marsh::Matrix<double> product{b};
+	leaqx8664::marsh::trmm(diag, 3, a, product);
+	leaqx8664::marsh::Matrix<double> expected = unpacked*b;
+	for (auto& x : expected)
+	    x *= 3;
+	bool result = close(product, expected);
+
+	leaqx8664::marsh::trsm(diag, 1.0/3, a, product);
+	result &= close(product, b);
+	return result;
+    }
+    bool test_triangular_kernels(){
+
+	return check_triangular(Triangle::lower, Diagonal::non_unit) && check_triangular(Triangle::upper, Diagonal::non_unit)
+	    && check_triangular(Triangle::lower, Diagonal::unit) && check_triangular(Triangle::upper, Diagonal::unit);
+    }
+    bool test_banded_kernels(){
+
+	leaqx8664::marsh::Matrix<double> full = dominant_test_matrix(300,280);
+	leaqx8664::marsh::Banded<double> a{full, 3, 2};
+	leaqx8664::marsh::Matrix<double> unpacked = a.unpack();
+
+	bool result = true;
+	for (auto trans : {Transpose::no_transpose, Transpose::transpose}){
+
+	    const bool transposed = trans == Transpose::transpose;
+	    leaqx8664::marsh::Vector<double> x{transposed ? 300U : 280U}, y{transposed ? 280U : 300U}, expected{y.get_size()};
+	    for (size_t i = 0; i < x.get_size(); ++i)
+		x(i) = 1.0 + i % 5;
+	    for (size_t i = 0; i < y.get_size(); ++i)
+		y(i) = expected(i) = 1;
+	    leaqx8664::marsh::gemv(trans, 2.0, unpacked, x, 3.0, expected);
+	    leaqx8664::marsh::gbmv(trans, 2, a, x, 3, y);
+	    for (size_t i = 0; i < y.get_size(); ++i)
+		result &= std::abs(y(i) - expected(i)) < 1e-9;
+	}
+
+	//tridiagonal operator with small diagonal, so the solver has to pivot
+	leaqx8664::marsh::Banded<double> operator_matrix{200, 200, 1, 1};
+	for (size_t i = 0; i < 200; ++i)
+	    for (size_t j = operator_matrix.first_column(i); j < operator_matrix.end_column(i); ++j)
+		operator_matrix(i,j) = i == j ? (i % 3 ? 0.1 : 2.0) : std::cos(1.0*i + 2.0*j);
+	leaqx8664::marsh::Vector<double> solution{200}, rhs{200};
+	for (size_t i = 0; i < 200; ++i)
+	    solution(i) = std::sin(0.1*i);
+	leaqx8664::marsh::gbmv(Transpose::no_transpose, 1, operator_matrix, solution, 0, rhs);
+	leaqx8664::marsh::gbsv(operator_matrix, rhs);
+	for (size_t i = 0; i < 200; ++i)
+	    result &= std::abs(rhs(i) - solution(i)) < 1e-9;
+	return result;
+    }
@@ -0,0 +1,189 @@
+//: tests/marsh/Reductions_tests.cpp
+
+#include "leaqx8664.hpp"
+#include <iostream>
+#include <iomanip>
+#include <array>
+#include <cmath>
+#include <atomic>
+#include <thread>
+
+std::array<int,8> test_2by4_matrix{1,-2,3,4,-5,6,7,-8};
+
+/////////////////////
+// WHOLE MATRIX TESTS
+/////////////////////
+    ////////////////////
+    // Test sum, mean, min, max, argmin and argmax on a matrix built from
+    // the values in test_2by4_matrix, for every layout
+    ////////////////////
+    bool test_whole_reductions();
+    ////////////////////
+    // Test that the compensated sum of a large matrix is accurate and
+    // does not change between runs with the same number of threads
+    ////////////////////
+    bool test_sum_accuracy();
+    ////////////////////
+    // Test sum, max and the Frobenius norm while another thread changes
+    // the number of threads
+    ////////////////////
+    bool test_concurrent_thread_count();
+
+/////////////////////
+// ROW AND COLUMN TESTS
+/////////////////////
+    ////////////////////
+    // Test per row and per column sums, means, minima and maxima
+    ////////////////////
+    bool test_line_reductions();
+
+/////////////////////
+// NORM TESTS
+/////////////////////
+    ////////////////////
+    // Test 1, infinity, Frobenius and 2 norms
+    ////////////////////
+    bool test_norms();
+
+
+int main(){
+
+    leaqx8664::marsh::set_num_threads(4);
+    std::cerr << std::setw(50) << std::left << "Whole matrix reductions test : " << (test_whole_reductions() ? "passed" : "failed") << std::endl;
+    std::cerr << std::setw(50) << std::left << "Sum accuracy test : " << (test_sum_accuracy() ? "passed" : "failed") << std::endl;
+    std::cerr << std::setw(50) << std::left << "Concurrent thread count test : " << (test_concurrent_thread_count() ? "passed" : "failed") << std::endl;
+    std::cerr << std::setw(50) << std::left << "Row and column reductions test : " << (test_line_reductions() ? "passed" : "failed") << std::endl;
+    std::cerr << std::setw(50) << std::left << "Norms test : " << (test_norms() ? "passed" : "failed") << std::endl;
+}
+
+/////////////////////
+// WHOLE MATRIX TESTS
+/////////////////////
+    template <typename L>
+    bool check_whole_reductions(){
+
+	leaqx8664::marsh::Matrix<int, L> mat{2,4};
+	for (size_t j = 0; j <= mat.get_max_index(); ++j)
+	    mat(j) = test_2by4_matrix[j];
+
+	//duplicate the minimum to check that the first one in row order is returned
+	leaqx8664::marsh::Matrix<int, L> ties{mat};
+	ties(1,3) = -5;
+
+	return leaqx8664::marsh::sum(mat) == 6 && leaqx8664::marsh::mean(mat) == 0
+	    && leaqx8664::marsh::min(mat) == -8 && leaqx8664::marsh::max(mat) == 7
+	    && leaqx8664::marsh::argmin(mat) == std::make_pair(size_t{1}, size_t{3})
+	    && leaqx8664::marsh::argmax(mat) == std::make_pair(size_t{1}, size_t{2})
+	    && leaqx8664::marsh::argmin(ties) == std::make_pair(size_t{1}, size_t{0});
+    }
+    bool test_whole_reductions(){
+
+	return check_whole_reductions<leaqx8664::marsh::Row_major>() && check_whole_reductions<leaqx8664::marsh::Column_major>()
+	    && check_whole_reductions<leaqx8664::marsh::Tiled<3>>() && check_whole_reductions<leaqx8664::marsh::Morton>();
+    }
+    bool test_sum_accuracy(){
+
+	//0.1 is not representable, a naive sum of a million of them drifts visibly
+	leaqx8664::marsh::Matrix<double> mat{1000,1000};
+	for (auto& x : mat)
+	    x = 0.1;
+	double first = leaqx8664::marsh::sum(mat);
+	double second = leaqx8664::marsh::sum(mat);
+
+	leaqx8664::marsh::Matrix<double, leaqx8664::marsh::Column_major> column_mat{mat};
+	return std::abs(first - 100000.0) < 1e-8 && first == second && std::abs(leaqx8664::marsh::sum(column_mat) - 100000.0) < 1e-8;
+    }
+
+    bool test_concurrent_thread_count(){
+
+	//enough rows for up to 31 chunks
+	leaqx8664::marsh::Matrix<double> mat{2048, 256};
+	for (size_t j = 0; j <= mat.get_max_index(); ++j)
+	    mat(j) = 1;
+	mat(1000, 100) = 3;
+
+	std::atomic<bool> done{false};
+	std::thread setter{[&done](){
+	    for (size_t n = 1; !done; n = n % 16 + 1)
+		leaqx8664::marsh::set_num_threads(n);
+	}};
+	bool result = true;
+	for (size_t round = 0; round < 50; ++round){
+
+	    result &= leaqx8664::marsh::sum(mat) == 2048*256 + 2 && leaqx8664::marsh::max(mat) == 3;
+	    result &= std::abs(leaqx8664::marsh::norm_frobenius(mat) - std::sqrt(2048*256 + 8.0)) < 1e-10*std::sqrt(2048*256 + 8.0);
+	}
+	done = true;
+	setter.join();
+	leaqx8664::marsh::set_num_threads(4);
+	return result;
+    }
+
+/////////////////////
+// ROW AND COLUMN TESTS
+/////////////////////
+    template <typename L>
+    bool check_line_reductions(){
+
+	leaqx8664::marsh::Matrix<int, L> mat{2,4};
+	for (size_t j = 0; j <= mat.get_max_index(); ++j)
+	    mat(j) = test_2by4_matrix[j];
+
+	auto row_sums = leaqx8664::marsh::row_sums(mat);
+	auto column_sums = leaqx8664::marsh::column_sums(mat);
+	auto row_means = leaqx8664::marsh::row_means(mat);
+	auto column_means = leaqx8664::marsh::column_means(mat);
+	auto row_minima = leaqx8664::marsh::row_minima(mat);
+	auto row_maxima = leaqx8664::marsh::row_maxima(mat);
+	auto column_minima = leaqx8664::marsh::column_minima(mat);
+	auto column_maxima = leaqx8664::marsh::column_maxima(mat);
+
+	bool result = row_sums.get_size() == 2 && column_sums.get_size() == 4;
+	result &= row_sums(0) == 6 && row_sums(1) == 0 && row_means(0) == 1 && row_means(1) == 0;
+	result &= row_minima(0) == -2 && row_minima(1) == -8 && row_maxima(0) == 4 && row_maxima(1) == 7;
+	for (size_t c = 0; c < 4; ++c){
+
+	    const int top = test_2by4_matrix[c], bottom = test_2by4_matrix[4 + c];
+	    result &= column_sums(c) == top + bottom && column_means(c) == (top + bottom)/2;
+	    result &= column_minima(c) == std::min(top, bottom) && column_maxima(c) == std::max(top, bottom);
+	}
+	return result;
+    }
+    bool test_line_reductions(){
+
+	bool result = check_line_reductions<leaqx8664::marsh::Row_major>() && check_line_reductions<leaqx8664::marsh::Column_major>()
+	    && check_line_reductions<leaqx8664::marsh::Tiled<3>>() && check_line_reductions<leaqx8664::marsh::Morton>();
+
+	//results split among threads must not depend on their number
+	leaqx8664::marsh::Matrix<double> mat{3000,300};
+	for (size_t j = 0; j <= mat.get_max_index(); ++j)
+	    mat(j) = 1.0/(1 + j % 97);
+	auto sums = leaqx8664::marsh::column_sums(mat);
+	leaqx8664::marsh::set_num_threads(1);
+	result &= (sums == leaqx8664::marsh::column_sums(mat));
+	leaqx8664::marsh::set_num_threads(4);
+	return result;
+    }
+
+/////////////////////
+// NORM TESTS
+/////////////////////
+    bool test_norms(){
+
+	leaqx8664::marsh::Matrix<double> mat{2,4};
+	for (size_t j = 0; j <= mat.get_max_index(); ++j)
+	    mat(j) = test_2by4_matrix[j];
+
+	bool result = leaqx8664::marsh::norm_1(mat) == 12 && leaqx8664::marsh::norm_inf(mat) == 26;
+	result &= std::abs(leaqx8664::marsh::norm_frobenius(mat) - std::sqrt(204.0)) < 1e-12;
+
+	//diagonal matrix: the 2-norm is the largest absolute value on the diagonal
+	leaqx8664::marsh::Matrix<double, leaqx8664::marsh::Column_major> diagonal{3,3};
+	for (size_t j = 0; j <= diagonal.get_max_index(); ++j)
+	    diagonal(j) = 0;
+	diagonal(0,0) = 2;
+	diagonal(1,1) = -5;
+	diagonal(2,2) = 3;
+	result &= std::abs(leaqx8664::marsh::norm_2(diagonal) - 5) < 1e-6;
+	return result;
+    }
@@ -0,0 +1,264 @@
+//: tests/marsh/Result_cache_tests.cpp
+
+#include "leaqx8664.hpp"
+#include "Test_helpers.hpp"
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+#include <thread>
+#include <vector>
+
+using leaqx8664::marsh::Matrix;
+using leaqx8664::marsh::Result_cache;
+
+/////////////////////
+// HASH TESTS
+/////////////////////
+    ////////////////////
+    // Test that hashes depend on elements and shape only, not on the
+    // number of threads, and that writes invalidate the cached hash
+    ////////////////////
+    bool test_content_hash();
+    ////////////////////
+    // Test operator== with and without sealed hashes
+    ////////////////////
+    bool test_hash_comparison();
+    ////////////////////
+    // Test that writes through views taken before hashing are seen by
+    // comparisons, copies and the cache
+    ////////////////////
+    bool test_writes_through_views();
+
+/////////////////////
+// CACHE TESTS
+/////////////////////
+    ////////////////////
+    // Test hits, misses and per operation enabling
+    ////////////////////
+    bool test_memoize();
+    ////////////////////
+    // Test least recently used eviction on entry and size limits
+    ////////////////////
+    bool test_eviction();
+    ////////////////////
+    // Test concurrent lookups from several threads
+    ////////////////////
+    bool test_concurrent_lookups();
+
+
+int main(){
+
+    leaqx8664::marsh::set_num_threads(4);
+    std::cerr << std::setw(50) << std::left << "Content hash test : " << (test_content_hash() ? "passed" : "failed") << std::endl;
+    std::cerr << std::setw(50) << std::left << "Hash comparison test : " << (test_hash_comparison() ? "passed" : "failed") << std::endl;
+    std::cerr << std::setw(50) << std::left << "Writes through views test : " << (test_writes_through_views() ? "passed" : "failed") << std::endl;
+    std::cerr << std::setw(50) << std::left << "Memoize test : " << (test_memoize() ? "passed" : "failed") << std::endl;
+    std::cerr << std::setw(50) << std::left << "Eviction test : " << (test_eviction() ? "passed" : "failed") << std::endl;
+    std::cerr << std::setw(50) << std::left << "Concurrent lookups test : " << (test_concurrent_lookups() ? "passed" : "failed") << std::endl;
+}
+
+/////////////////////
+// HASH TESTS
+/////////////////////
+    bool test_content_hash(){
+
+	//large enough to be hashed by several threads
+	Matrix<double> a = test_matrix(300, 250, 0.0);
+	const Matrix<double> b = test_matrix(300, 250, 0.0);
+	const auto hash = a.get_hash();
+	bool result = hash == b.get_hash() && hash == a.get_hash();
+
+	leaqx8664::marsh::set_num_threads(1);
+	result &= test_matrix(300, 250, 0.0).get_hash() == hash;
+	leaqx8664::marsh::set_num_threads(4);
+
+	//the hash follows writes
+	a(299, 249) += 1;
+	result &= a.get_hash() != hash;
+	a.data()[a.get_layout().offset(299, 249)] -= 1;
+	result &= a.get_hash() == hash;
+	a.get_block(10, 10, 2, 2)(1, 1) = 5;
+	result &= a.get_hash() != hash;
+
+	//same storage with another shape, and signed zeros
+	Matrix<double> row{1, 6}, column{6, 1}, negative{1, 6};
+	for (size_t i = 0; i < 6; ++i){
+
+	    row(i) = column(i) = 0.0;
+	    negative(i) = -0.0;
+	}
+	result &= row.get_hash() != column.get_hash() && row.get_hash() == negative.get_hash();
+
+	//copies have the same hash
+	const Matrix<double> copy = b;
+	result &= copy.get_hash() == hash;
+	return result;
+    }
+    bool test_hash_comparison(){
+
+	const Matrix<double> a = test_matrix(40, 30, 0.0), b = test_matrix(40, 30, 0.0), c = test_matrix(40, 30, 1.0);
+	bool result = a == b && a != c && !a.is_sealed();
+	result &= a.seal() == a.get_hash() && a.is_sealed();
+	b.seal();
+	c.seal();
+	result &= a == b && a != c && b != c;
+
+	//different layouts are compared element by element
+	const auto tiled = test_matrix<leaqx8664::marsh::Tiled<8>>(40, 30, 0.0);
+	tiled.seal();
+	result &= a == tiled && c != tiled;
+
+	//copies are not sealed, write access and assignments drop the seal
+	Matrix<double> copy = a;
+	result &= !copy.is_sealed() && copy == a;
+	copy.seal();
+	copy(0, 0) = 7;
+	result &= !copy.is_sealed() && copy != a;
+	copy.seal();
+	copy = c;
+	result &= !copy.is_sealed() && copy == c;
+
+	//NaN elements still compare different with equal hashes
+	Matrix<double> nan{2, 2};
+	for (size_t i = 0; i < 4; ++i)
+	    nan(i) = std::nan("");
+	const Matrix<double> nan_copy = nan;
+	result &= nan.get_hash() == nan_copy.get_hash() && nan != nan_copy;
+	return result;
+    }
+
+    bool test_writes_through_views(){
+
+	Matrix<double> a = test_matrix(20, 20, 0.0);
+	const Matrix<double> b = test_matrix(20, 20, 1.0);
+	auto column = a.column(0);
+	const auto hash = a.get_hash();
+	Result_cache cache;
+	cache.enable("multiply");
+	bool result = leaqx8664::marsh::cached_multiply(cache, a, b) == a*b;
+
+	//scal writes through a view taken before the hash was computed
+	leaqx8664::marsh::scal(2.0, column);
+	Matrix<double> d = test_matrix(20, 20, 0.0);
+	for (size_t i = 0; i < 20; ++i)
+	    d(i, 0) *= 2;
+	d.get_hash();
+	result &= a.get_hash() != hash && a.get_hash() == d.get_hash() && a == d;
+	const Matrix<double> copy = a;
+	result &= copy.get_hash() == d.get_hash() && copy == d;
+
+	//the cache sees the new elements
+	result &= close(leaqx8664::marsh::cached_multiply(cache, a, b), d*b);
+	result &= cache.get_statistics().hits == 0 && cache.get_statistics().misses == 2;
+	result &= close(leaqx8664::marsh::cached_multiply(cache, d, b), d*b) && cache.get_statistics().hits == 1;
+	return result;
+    }
+
+/////////////////////
+// CACHE TESTS
+/////////////////////
+    bool test_memoize(){
+
+	Result_cache cache;
+	const Matrix<double> a = test_matrix(20, 30, 0.0), b = test_matrix(30, 10, 1.0);
+	const Matrix<double> expected = a*b;
+
+	//disabled operations are computed and not counted
+	bool result = leaqx8664::marsh::cached_multiply(cache, a, b) == expected && cache.get_statistics().misses == 0;
+
+	cache.enable("multiply");
+	result &= leaqx8664::marsh::cached_multiply(cache, a, b) == expected;
+	//equal inputs in other objects hit
+	const Matrix<double> a_copy = test_matrix(20, 30, 0.0), b_copy = test_matrix(30, 10, 1.0);
+	result &= leaqx8664::marsh::cached_multiply(cache, a_copy, b_copy) == expected;
+	//different inputs miss
+	result &= leaqx8664::marsh::cached_multiply(cache, test_matrix(20, 30, 2.0), b) == test_matrix(20, 30, 2.0)*b;
+
+	auto statistics = cache.get_statistics();
+	result &= statistics.hits == 1 && statistics.misses == 2 && statistics.entries == 2 && std::abs(statistics.hit_rate() - 1.0/3) < 1e-12;
+
+	//scalar arguments are part of the key
+	cache.enable("scale");
+	size_t calls = 0;
+	auto scale = [&calls](const Matrix<double>& m, double alpha){
+	    ++calls;
+	    Matrix<double> scaled = m;
+	    for (size_t i = 0; i <= scaled.get_max_index(); ++i)
+		scaled(i) *= alpha;
+	    return scaled;
+	};
+	cache.memoize("scale", scale, a, 2.0);
+	cache.memoize("scale", scale, a, 3.0);
+	result &= cache.memoize("scale", scale, a, 2.0)(0, 1) == 2*a(0, 1) && calls == 2;
+
+	cache.enable("scale", false);
+	cache.memoize("scale", scale, a, 2.0);
+	result &= calls == 3 && !cache.is_enabled("scale") && cache.is_enabled("multiply");
+	return result;
+    }
+    bool test_eviction(){
+
+	const size_t matrix_bytes = sizeof(Matrix<double>) + 100*sizeof(double);
+	Result_cache cache{10*matrix_bytes, 3};
+	cache.enable("copy");
+	auto copy = [](const Matrix<double>& m){ return m;};
+	std::vector<Matrix<double>> inputs;
+	for (size_t i = 0; i < 4; ++i)
+	    inputs.push_back(test_matrix(10, 10, i));
+
+	//entries limit: the least recently used of 0, 1, 2 is 1 after using 0 again
+	cache.memoize("copy", copy, inputs[0]);
+	cache.memoize("copy", copy, inputs[1]);
+	cache.memoize("copy", copy, inputs[2]);
+	cache.memoize("copy", copy, inputs[0]);
+	cache.memoize("copy", copy, inputs[3]);
+	auto statistics = cache.get_statistics();
+	bool result = statistics.entries == 3 && statistics.evictions == 1 && statistics.size == 3*matrix_bytes;
+	cache.reset_statistics();
+	cache.memoize("copy", copy, inputs[0]);
+	cache.memoize("copy", copy, inputs[1]);
+	statistics = cache.get_statistics();
+	result &= statistics.hits == 1 && statistics.misses == 1;
+
+	//size limit
+	cache.set_capacity(2*matrix_bytes, 3);
+	statistics = cache.get_statistics();
+	result &= statistics.entries == 2 && statistics.size == 2*matrix_bytes;
+	//results larger than the capacity are not cached
+	cache.memoize("copy", copy, test_matrix(20, 20, 0.0));
+	result &= cache.get_statistics().entries == 2;
+
+	cache.clear();
+	statistics = cache.get_statistics();
+	result &= statistics.entries == 0 && statistics.size == 0;
+	return result;
+    }
+    bool test_concurrent_lookups(){
+
+	Result_cache cache{size_t{1} << 24, 8};
+	cache.enable("multiply");
+	std::vector<Matrix<double>> inputs;
+	for (size_t i = 0; i < 12; ++i)
+	    inputs.push_back(test_matrix(16, 16, i));
+
+	std::vector<int> correct(4, 1);
+	std::vector<std::thread> threads;
+	for (size_t t = 0; t < 4; ++t)
+	    threads.emplace_back([&, t](){
+		for (size_t k = 0; k < 200; ++k){
+
+		    const auto& a = inputs[(k + t) % inputs.size()];
+		    const auto& b = inputs[(3*k) % inputs.size()];
+		    if (leaqx8664::marsh::cached_multiply(cache, a, b) != a*b)
+			correct[t] = 0;
+		}
+	    });
+	for (auto& thread : threads)
+	    thread.join();
+
+	const auto statistics = cache.get_statistics();
+	bool result = statistics.hits + statistics.misses == 800 && statistics.entries <= 8;
+	for (const auto c : correct)
+	    result &= c == 1;
+	return result;
+    }
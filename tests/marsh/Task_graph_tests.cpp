@@ -0,0 +1,246 @@
+//: tests/marsh/Task_graph_tests.cpp
+
+#include "leaqx8664.hpp"
+#include "Test_helpers.hpp"
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+#include <stdexcept>
+
+using leaqx8664::marsh::Matrix;
+using leaqx8664::marsh::Task_graph;
+using leaqx8664::marsh::Thread_pool;
+
+/////////////////////
+// BLOCK TESTS
+/////////////////////
+    ////////////////////
+    // Test access to the elements of a matrix through blocks
+    // and copy of blocks
+    ////////////////////
+    bool test_matrix_block();
+
+/////////////////////
+// GRAPH TESTS
+/////////////////////
+    ////////////////////
+    // Test a graph of products and sums against direct computation
+    ////////////////////
+    bool test_graph_results();
+    ////////////////////
+    // Test fused element wise chains, with and without requested
+    // intermediate values, and padded layouts
+    ////////////////////
+    bool test_elementwise_fusion();
+    ////////////////////
+    // Test propagation of exceptions to dependent nodes
+    ////////////////////
+    bool test_exception_propagation();
+    ////////////////////
+    // Test the tiled Cholesky factorisation
+    ////////////////////
+    bool test_tiled_cholesky();
+
+
+int main(){
+
+    leaqx8664::marsh::set_num_threads(4);
+    std::cerr << std::setw(50) << std::left << "Matrix block test : " << (test_matrix_block() ? "passed" : "failed") << std::endl;
+    std::cerr << std::setw(50) << std::left << "Graph results test : " << (test_graph_results() ? "passed" : "failed") << std::endl;
+    std::cerr << std::setw(50) << std::left << "Element wise fusion test : " << (test_elementwise_fusion() ? "passed" : "failed") << std::endl;
+    std::cerr << std::setw(50) << std::left << "Exception propagation test : " << (test_exception_propagation() ? "passed" : "failed") << std::endl;
+    std::cerr << std::setw(50) << std::left << "Tiled Cholesky test : " << (test_tiled_cholesky() ? "passed" : "failed") << std::endl;
+}
+
+/////////////////////
+// BLOCK TESTS
+/////////////////////
+    bool test_matrix_block(){
+
+	Matrix<double> mat = test_matrix(6, 5, 0.0);
+	auto block = mat.get_block(1, 2, 3, 2);
+	bool result = block.get_shape() == std::make_pair<size_t, size_t>(3, 2) && block(2,1) == mat(3,3);
+	block(0,0) = 42;
+	result &= mat(1,2) == 42;
+
+	Matrix<double> copy{block};
+	result &= copy.get_shape() == block.get_shape() && copy(0,0) == 42 && copy(2,1) == mat(3,3);
+
+	try{
+	    mat.get_block(4, 0, 3, 1);
+	    result = false;
+	}
+	catch (IndexOutOfBoundsException&){}
+	try{
+	    block(3,0);
+	    result = false;
+	}
+	catch (IndexOutOfBoundsException&){}
+	return result;
+    }
+
+/////////////////////
+// GRAPH TESTS
+/////////////////////
+    bool test_graph_results(){
+
+	const Matrix<double> a = test_matrix(20, 30, 0.0), b = test_matrix(30, 10, 1.0), c = test_matrix(20, 10, 2.0);
+	const Matrix<double> d = test_matrix(10, 20, 3.0);
+
+	Thread_pool pool{3};
+	Task_graph graph;
+	auto na = graph.input(a), nb = graph.input(b), nc = graph.input(c), nd = graph.input(d);
+	auto ab = graph.multiply(na, nb);
+	auto sum = graph.add(ab, nc);
+	auto product = graph.multiply(sum, nd);
+	auto trace = graph.apply([](const Matrix<double>& m){
+	    double value = 0;
+	    for (size_t i = 0; i < m.get_shape().first; ++i)
+		value += m(i,i);
+	    return value;
+	}, product);
+	auto sum_future = graph.future(sum);
+	auto product_future = graph.future(product);
+	auto trace_future = graph.future(trace);
+	graph.run(pool);
+
+	Matrix<double> expected_sum = a*b;
+	for (size_t i = 0; i <= expected_sum.get_max_index(); ++i)
+	    expected_sum(i) += c(i);
+	const Matrix<double> expected_product = expected_sum*d;
+	double expected_trace = 0;
+	for (size_t i = 0; i < 20; ++i)
+	    expected_trace += expected_product(i,i);
+
+	bool result = close(sum_future.get(), expected_sum) && close(product_future.get(), expected_product);
+	result &= std::abs(trace_future.get() - expected_trace) < 1e-9;
+	graph.wait();
+	return result;
+    }
+    bool test_elementwise_fusion(){
+
+	const Matrix<double> a = test_matrix(37, 23, 0.0), b = test_matrix(37, 23, 1.0), c = test_matrix(37, 23, 2.0);
+	const auto tiled_a = test_matrix<leaqx8664::marsh::Tiled<4>>(37, 23, 0.0);
+	const auto tiled_b = test_matrix<leaqx8664::marsh::Tiled<4>>(37, 23, 1.0);
+
+	Thread_pool pool{2};
+	Task_graph graph;
+	auto na = graph.input(a), nb = graph.input(b), nc = graph.input(c);
+	//(2a - b) + c*c, with the difference requested and the scaling fused
+	auto difference = graph.subtract(graph.scale(2.0, na), nb);
+	auto squares = graph.elementwise([](double x){ return x*x;}, nc);
+	auto total = graph.add(difference, squares);
+	auto three = graph.elementwise([](double x, double y, double z){ return x*y + z;}, na, nb, nc);
+	auto tiled = graph.add(graph.scale(3.0, graph.input(tiled_a)), graph.input(tiled_b));
+	auto difference_future = graph.future(difference);
+	auto total_future = graph.future(total);
+	auto three_future = graph.future(three);
+	auto tiled_future = graph.future(tiled);
+	graph.run(pool);
+
+	bool result = true;
+	for (size_t i = 0; i < 37; ++i)
+	    for (size_t j = 0; j < 23; ++j){
+
+		result &= std::abs(difference_future.get()(i,j) - (2*a(i,j) - b(i,j))) < 1e-12;
+		result &= std::abs(total_future.get()(i,j) - (2*a(i,j) - b(i,j) + c(i,j)*c(i,j))) < 1e-12;
+		result &= std::abs(three_future.get()(i,j) - (a(i,j)*b(i,j) + c(i,j))) < 1e-12;
+		result &= std::abs(tiled_future.get()(i,j) - (3*a(i,j) + b(i,j))) < 1e-12;
+	    }
+	return result;
+    }
+    bool test_exception_propagation(){
+
+	Thread_pool pool{2};
+	Task_graph graph;
+	auto a = graph.input(test_matrix(3, 4, 0.0)), b = graph.input(test_matrix(4, 3, 0.0));
+	//shape mismatch in an element wise node, seen by its consumers
+	auto sum = graph.add(a, b);
+	auto product = graph.multiply(sum, b);
+	auto failing = graph.apply([](const Matrix<double>&) -> int { throw std::runtime_error{"failure"};}, a);
+	auto dependent = graph.task([](){}, {failing});
+	auto independent = graph.multiply(a, b);
+	auto product_future = graph.future(product);
+	auto failing_future = graph.future(failing);
+	auto independent_future = graph.future(independent);
+	graph.run(pool);
+
+	bool result = false;
+	try{
+	    product_future.get();
+	}
+	catch (ShapeMismatchException&){
+	    result = true;
+	}
+	try{
+	    failing_future.get();
+	    result = false;
+	}
+	catch (std::runtime_error&){}
+	try{
+	    graph.completion(dependent).get();
+	    result = false;
+	}
+	catch (std::runtime_error&){}
+	result &= independent_future.get().get_shape() == std::make_pair<size_t, size_t>(3, 3);
+	graph.wait();
+	return result;
+    }
+    bool test_tiled_cholesky(){
+
+	//symmetric positive definite matrix b*b^T + n*I
+	const size_t n = 23;
+	const Matrix<double> b = test_matrix(n, n, 0.0);
+	Matrix<double> a{n, n};
+	for (size_t i = 0; i < n; ++i)
+	    for (size_t j = 0; j < n; ++j){
+
+		a(i,j) = i == j ? n : 0.0;
+		for (size_t k = 0; k < n; ++k)
+		    a(i,j) += b(i,k)*b(j,k);
+	    }
+	const Matrix<double> original = a;
+
+	Thread_pool pool{4};
+	bool result = true;
+	{
+	    Task_graph graph;
+	    auto last = leaqx8664::marsh::tiled_cholesky(graph, a, 5);
+	    graph.run(pool);
+	    graph.completion(last).get();
+	}
+	for (size_t i = 0; i < n; ++i)
+	    for (size_t j = 0; j <= i; ++j){
+
+		double value = 0;
+		for (size_t k = 0; k <= j; ++k)
+		    value += a(i,k)*a(j,k);
+		result &= std::abs(value - original(i,j)) < 1e-9;
+		if (j < i)
+		    result &= a(j,i) == original(j,i);
+	    }
+
+	//tiles must not be empty
+	try{
+	    Task_graph empty_tiles;
+	    leaqx8664::marsh::tiled_cholesky(empty_tiles, a, 0);
+	    result = false;
+	}
+	catch (std::invalid_argument&){}
+
+	//not positive definite
+	Matrix<double> indefinite{original};
+	indefinite(7,7) = -1;
+	for (size_t j = 0; j < 7; ++j)
+	    indefinite(7,j) = 0;
+	Task_graph graph;
+	auto last = leaqx8664::marsh::tiled_cholesky(graph, indefinite, 5);
+	graph.run(pool);
+	try{
+	    graph.completion(last).get();
+	    result = false;
+	}
+	catch (SingularMatrixException&){}
+	graph.wait();
+	return result;
+    }
@@ -0,0 +1,50 @@
+//: tests/marsh/Test_helpers.hpp
+
+#ifndef TESTS_MARSH_TEST_HELPERS_HPP
+#define TESTS_MARSH_TEST_HELPERS_HPP
+
+#include "leaqx8664.hpp"
+#include <cmath>
+
+    ////////////////////
+    // Matrix with element (i,j) depending on both indices, different
+    // matrices of the same shape being obtained changing shift
+    ////////////////////
+    template <typename L = leaqx8664::marsh::Row_major>
+    leaqx8664::marsh::Matrix<double, L> test_matrix(size_t n_rows, size_t n_columns, double shift = 0.0){
+
+	leaqx8664::marsh::Matrix<double, L> mat{n_rows, n_columns};
+	for (size_t i = 0; i < n_rows; ++i)
+	    for (size_t j = 0; j < n_columns; ++j)
+		mat(i,j) = std::cos(shift + 0.5*i + 0.25*j);
+	return mat;
+    }
+    ////////////////////
+    // test_matrix with 10 added to the diagonal, so that its triangles
+    // and bands are well conditioned
+    ////////////////////
+    template <typename L = leaqx8664::marsh::Row_major>
+    leaqx8664::marsh::Matrix<double, L> dominant_test_matrix(size_t n_rows, size_t n_columns, double shift = 0.0){
+
+	auto mat = test_matrix<L>(n_rows, n_columns, shift);
+	for (size_t i = 0; i < n_rows && i < n_columns; ++i)
+	    mat(i,i) += 10.0;
+	return mat;
+    }
+    ////////////////////
+    // Check that two matrices, of any storage, have the same shape and
+    // elements equal up to 1e-9
+    ////////////////////
+    template <typename M1, typename M2>
+    bool close(const M1& a, const M2& b){
+
+	if (a.get_shape() != b.get_shape())
+	    return false;
+	for (size_t i = 0; i < a.get_shape().first; ++i)
+	    for (size_t j = 0; j < a.get_shape().second; ++j)
+		if (std::abs(a(i,j) - b(i,j)) > 1e-9)
+		    return false;
+	return true;
+    }
+
+#endif
@@ -0,0 +1,129 @@
+//: tests/marsh/Vector_tests.cpp
+
+#include "leaqx8664.hpp"
+#include <iostream>
+#include <iomanip>
+#include <array>
+
+std::array<int,8> test_2by4_matrix{1,2,3,4,5,6,7,8};
+
+/////////////////////
+// VECTOR TESTS
+/////////////////////
+    ////////////////////
+    // Test operator(), get_size and iteration on a vector
+    ////////////////////
+    bool test_vector_access();
+    ////////////////////
+    // Test copy and move of vectors
+    ////////////////////
+    bool test_vector_copy_move();
+
+/////////////////////
+// VIEW TESTS
+/////////////////////
+    ////////////////////
+    // Test row and column views of row major and column major matrices
+    // built from the values in test_2by4_matrix
+    ////////////////////
+    bool test_matrix_views();
+    ////////////////////
+    // Test that writes through a view change the matrix
+    ////////////////////
+    bool test_view_write();
+
+
+int main(){
+
+    std::cerr << std::setw(50) << std::left << "Vector access test : " << (test_vector_access() ? "passed" : "failed") << std::endl;
+    std::cerr << std::setw(50) << std::left << "Vector copy and move test : " << (test_vector_copy_move() ? "passed" : "failed") << std::endl;
+    std::cerr << std::setw(50) << std::left << "Matrix views test : " << (test_matrix_views() ? "passed" : "failed") << std::endl;
+    std::cerr << std::setw(50) << std::left << "View write test : " << (test_view_write() ? "passed" : "failed") << std::endl;
+}
+
+/////////////////////
+// VECTOR TESTS
+/////////////////////
+    bool test_vector_access(){
+
+	leaqx8664::marsh::Vector<int> vec{8};
+	size_t i = 0;
+	for (auto& x : vec)
+	    x = test_2by4_matrix[i++];
+
+	bool result = vec.get_size() == 8;
+	for (size_t j = 0; j < 8; ++j)
+	    result &= (vec(j) == test_2by4_matrix[j]);
+	try{
+	    vec(8);
+	    result = false;
+	}
+	catch (IndexOutOfBoundsException&){}
+	return result;
+    }
+    bool test_vector_copy_move(){
+
+	leaqx8664::marsh::Vector<int> vec{8};
+	for (size_t j = 0; j < 8; ++j)
+	    vec(j) = test_2by4_matrix[j];
+
+	leaqx8664::marsh::Vector<int> vec2{vec};
+	bool result = (vec2 == vec);
+	++(vec2(0));
+	result &= (vec2 != vec);
+	leaqx8664::marsh::Vector<int> vec3{std::move(vec2)};
+	vec2 = vec;
+	result &= (vec2 == vec) && (vec3(0) == vec(0) + 1);
+	return result;
+    }
+
+/////////////////////
+// VIEW TESTS
+/////////////////////
+    template <typename L>
+    bool check_matrix_views(){
+
+	leaqx8664::marsh::Matrix<int, L> mat{2,4};
+	for (size_t j = 0; j <= mat.get_max_index(); ++j)
+	    mat(j) = test_2by4_matrix[j];
+
+	bool result = true;
+	for (size_t r = 0; r < 2; ++r){
+
+	    auto row = mat.row(r);
+	    result &= (row.get_size() == 4);
+	    for (size_t c = 0; c < 4; ++c)
+		result &= (row(c) == test_2by4_matrix[r*4 + c]);
+	}
+	const leaqx8664::marsh::Matrix<int, L>& const_mat = mat;
+	for (size_t c = 0; c < 4; ++c){
+
+	    auto column = const_mat.column(c);
+	    result &= (column.get_size() == 2);
+	    for (size_t r = 0; r < 2; ++r)
+		result &= (column(r) == test_2by4_matrix[r*4 + c]);
+	}
+	leaqx8664::marsh::Vector<int> copy{mat.column(1)};
+	result &= (copy(0) == 2) && (copy(1) == 6);
+	return result;
+    }
+    bool test_matrix_views(){
+
+	return check_matrix_views<leaqx8664::marsh::Row_major>() && check_matrix_views<leaqx8664::marsh::Column_major>();
+    }
+    bool test_view_write(){
+
+	leaqx8664::marsh::Matrix<int> mat{2,4};
+	for (size_t j = 0; j <= mat.get_max_index(); ++j)
+	    mat(j) = test_2by4_matrix[j];
+
+	auto column = mat.column(2);
+	column(1) = 0;
+	bool result = (mat(1,2) == 0);
+	try{
+	    mat.row(2);
+	    result = false;
+	}
+	catch (IndexOutOfBoundsException&){}
+	return result;
+    }